@@ -0,0 +1,66 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif  // _MSC_VER
+
+namespace Bench {
+
+// Prevents the compiler from optimizing away the computation of v
+template<typename T>
+inline void do_not_optimize(T& v) noexcept
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(v) : "memory");
+#else
+    _ReadWriteBarrier();
+    (void)v;
+#endif
+}
+
+inline void clobber_memory() noexcept
+{
+#if defined(__GNUC__)
+    asm volatile("" : : : "memory");
+#else
+    _ReadWriteBarrier();
+#endif
+}
+
+// Average wall clock time of one invocation of f in nanoseconds, the best
+// of a few repetitions is taken to filter out scheduling noise
+template<typename F>
+double ns_per_op(F&& f, size_t iterations, size_t repetitions = 5)
+{
+    using clock = std::chrono::steady_clock;
+    double best = 0.0;
+    for (size_t r = 0; r < repetitions; ++r) {
+        auto start = clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            f();
+        }
+        clobber_memory();
+        std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        auto ns = elapsed.count() / static_cast<double>(iterations);
+        if (r == 0 || ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+inline void print_header(const char* title, const char* columns)
+{
+    std::printf("\n%s\n%s\n", title, columns);
+}
+
+}  // namespace Bench
+
+#endif  // BENCH_H_
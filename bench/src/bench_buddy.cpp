@@ -0,0 +1,115 @@
+// Throughput and fragmentation of estd::buddy_resource_t and malloc for a
+// random mix of large buffers between 4 KB and 16 MB
+
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "memory_resource.h"
+#include "bench.h"
+
+namespace {
+
+constexpr size_t region_size = size_t { 1 } << 30;
+constexpr size_t operations = 200000;
+constexpr size_t live_bytes = 256 * 1024 * 1024;
+
+using buddy_t = estd::buddy_resource_t<4096, 16 * 1024 * 1024>;
+
+struct result_t {
+    double mops;
+    size_t requested;
+    size_t failures;
+};
+
+// keeps about live_bytes of log-uniformly sized buffers alive, first
+// touching each buffer to include the cost of page faults
+template<class Allocate, class Deallocate>
+result_t run(Allocate&& allocate, Deallocate&& deallocate,
+    std::vector<std::pair<void*, size_t>>& live)
+{
+    using clock = std::chrono::steady_clock;
+    std::mt19937 random { 5 };
+    std::uniform_real_distribution<double> log_size { std::log(4096.0), std::log(16.0 * 1024 * 1024) };
+    result_t r { 0.0, 0, 0 };
+    auto start = clock::now();
+    for (size_t i = 0; i < operations; ++i) {
+        if (r.requested < live_bytes || live.empty()) {
+            auto n = static_cast<size_t>(std::exp(log_size(random)));
+            auto p = allocate(n);
+            if (!p) {
+                ++r.failures;
+                continue;
+            }
+            static_cast<volatile uint8_t*>(p)[0] = 1;
+            live.emplace_back(p, n);
+            r.requested += n;
+        } else {
+            auto index = random() % live.size();
+            auto b = live[index];
+            live[index] = live.back();
+            live.pop_back();
+            deallocate(b.first, b.second);
+            r.requested -= b.second;
+        }
+    }
+    std::chrono::duration<double, std::micro> elapsed = clock::now() - start;
+    r.mops = static_cast<double>(operations) / elapsed.count();
+    return r;
+}
+
+}  // namespace
+
+int main()
+{
+    estd::mapping_options_t options;
+    options.huge_pages = false;
+    auto region = estd::map_memory(region_size, options);
+    buddy_t buddy { region.resource() };
+
+    std::vector<std::pair<void*, size_t>> live;
+    auto b = run([&buddy](size_t n) -> void* {
+        try {
+            return buddy.allocate(n, 16);
+        } catch (const std::bad_alloc&) {
+            return nullptr;
+        }
+    }, [&buddy](void* p, size_t n) { buddy.deallocate(p, n, 16); }, live);
+    size_t blocks = 0;
+    for (auto& l : live) {
+        blocks += buddy_t::block_size_for(l.second);
+    }
+    std::printf("%zu operations, about %zu MiB live, buffers of 4 KB .. 16 MB\n",
+        operations, live_bytes >> 20);
+    Bench::print_header("buddy_resource_t",
+        "M ops/s\tfailed\tblock / requested\tfree [MiB]\tlargest free [MiB]");
+    std::printf("%.2f\t%zu\t%.2f\t\t\t%zu\t\t%zu\n", b.mops, b.failures,
+        static_cast<double>(blocks) / static_cast<double>(b.requested),
+        buddy.free_size() >> 20, buddy.largest_free_block() >> 20);
+    for (auto& l : live) {
+        buddy.deallocate(l.first, l.second, 16);
+    }
+    live.clear();
+
+    auto m = run([](size_t n) { return std::malloc(n); },
+        [](void* p, size_t) { std::free(p); }, live);
+    Bench::print_header("malloc", "M ops/s\tfootprint / requested");
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    auto info = mallinfo2();
+    std::printf("%.2f\t%.2f\n", m.mops,
+        static_cast<double>(info.arena + info.hblkhd) / static_cast<double>(m.requested));
+#else
+    std::printf("%.2f\tn/a\n", m.mops);
+#endif
+    for (auto& l : live) {
+        std::free(l.first);
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+// TLB heavy random access over nodes allocated from a monotonic_arena_t on
+// estd::map_memory blocks backed by normal and by huge pages
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "memory_resource.h"
+#include "bench.h"
+
+namespace {
+
+constexpr size_t pool_size = 256 * 1024 * 1024;
+constexpr size_t accesses = 4000000;
+
+struct node {
+    node* next;
+    size_t payload[7];
+};
+
+// links the nodes allocated from the block in random order and chases the
+// pointers, so nearly every access touches a different page
+double ns_per_access(const estd::mapped_memory_t& m)
+{
+    estd::monotonic_arena_t arena { m.resource() };
+    std::vector<node*> nodes(m.size() / sizeof(node));
+    for (auto& n : nodes) {
+        n = ::new (arena.allocate(sizeof(node), alignof(node))) node { };
+    }
+    std::shuffle(nodes.begin(), nodes.end(), std::mt19937_64 { 42 });
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        nodes[i]->next = nodes[(i + 1) % nodes.size()];
+    }
+    auto n = nodes.front();
+    return Bench::ns_per_op([&n] {
+        n = n->next;
+        Bench::do_not_optimize(n);
+    }, accesses, 3);
+}
+
+}  // namespace
+
+int main()
+{
+    estd::mapping_options_t normal;
+    normal.huge_pages = false;
+    normal.populate = true;
+    estd::mapping_options_t huge;
+    huge.populate = true;
+
+    auto m1 = estd::map_memory(pool_size, normal);
+    auto m2 = estd::map_memory(pool_size, huge);
+
+    std::printf("random pointer chasing over %zu MiB\n", pool_size >> 20);
+    Bench::print_header("access [ns]", "pages\thuge_pages()\tadvised\tns");
+    std::printf("normal\t%d\t\t%d\t%.1f\n", m1.huge_pages(), m1.huge_pages_advised(),
+        ns_per_access(m1));
+    std::printf("huge\t%d\t\t%d\t%.1f\n", m2.huge_pages(), m2.huge_pages_advised(),
+        ns_per_access(m2));
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Compares the call latency and object size of estd::interface (virtual
+// dispatch), estd::table_interface (function pointer table) and
+// std::function
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+#include "functional.h"
+#include "bench.h"
+
+namespace {
+
+constexpr size_t callables = 64;
+constexpr size_t iterations = 200000;
+
+using virtual_if = estd::interface<int(int)>;
+using table_if = estd::table_interface<int(int)>;
+using std_function = std::function<int(int)>;
+
+struct Add {
+    int operator()(int i) const
+    {
+        return i + n;
+    }
+    int n;
+};
+
+struct Mul {
+    int operator()(int i) const
+    {
+        return i * n;
+    }
+    int n;
+};
+
+// alternating implementation types defeat devirtualization
+template<typename F>
+std::vector<F> make_callables()
+{
+    std::vector<F> v;
+    for (size_t i = 0; i < callables; ++i) {
+        if (i % 2 == 0) {
+            v.emplace_back(Add{ static_cast<int>(i) });
+        } else {
+            v.emplace_back(Mul{ static_cast<int>(i) });
+        }
+    }
+    return v;
+}
+
+template<typename F>
+double bench_call()
+{
+    auto v = make_callables<F>();
+    return Bench::ns_per_op([&v] {
+        int acc = 0;
+        for (auto& f : v) {
+            acc = f(acc);
+        }
+        Bench::do_not_optimize(acc);
+    }, iterations) / callables;
+}
+
+template<typename F>
+double bench_copy()
+{
+    auto v = make_callables<F>();
+    return Bench::ns_per_op([&v] {
+        std::vector<F> c(v);
+        Bench::do_not_optimize(c);
+    }, iterations / 10) / callables;
+}
+
+}  // namespace
+
+int main()
+{
+    Bench::print_header("object size [bytes]",
+        "estd::interface\testd::table_interface\tstd::function");
+    std::printf("%zu\t\t%zu\t\t\t%zu\n",
+        sizeof(virtual_if), sizeof(table_if), sizeof(std_function));
+
+    Bench::print_header("call [ns/call]",
+        "estd::interface\testd::table_interface\tstd::function");
+    std::printf("%.2f\t\t%.2f\t\t\t%.2f\n",
+        bench_call<virtual_if>(), bench_call<table_if>(),
+        bench_call<std_function>());
+
+    Bench::print_header("copy [ns/object]",
+        "estd::interface\testd::table_interface\tstd::function");
+    std::printf("%.2f\t\t%.2f\t\t\t%.2f\n",
+        bench_copy<virtual_if>(), bench_copy<table_if>(),
+        bench_copy<std_function>());
+    return 0;
+}
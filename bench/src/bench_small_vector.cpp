@@ -0,0 +1,87 @@
+// Compares estd::small_vector with std::vector for push_back, iteration
+// and copy at sizes 0..64
+
+#include <cstdio>
+#include <vector>
+
+#include "vector.h"
+#include "bench.h"
+
+namespace {
+
+constexpr size_t inline_elements = 8;
+constexpr size_t iterations = 200000;
+
+using small_vec = estd::small_vector<int, inline_elements>;
+using std_vec = std::vector<int>;
+
+template<typename V>
+double bench_push_back(size_t n)
+{
+    return Bench::ns_per_op([n] {
+        V v;
+        for (size_t i = 0; i < n; ++i) {
+            v.push_back(static_cast<int>(i));
+        }
+        Bench::do_not_optimize(v);
+    }, iterations);
+}
+
+template<typename V>
+double bench_iterate(size_t n)
+{
+    V v;
+    for (size_t i = 0; i < n; ++i) {
+        v.push_back(static_cast<int>(i));
+    }
+    return Bench::ns_per_op([&v] {
+        int sum = 0;
+        for (auto i : v) {
+            sum += i;
+        }
+        Bench::do_not_optimize(sum);
+        Bench::clobber_memory();
+    }, iterations);
+}
+
+template<typename V>
+double bench_copy(size_t n)
+{
+    V v;
+    for (size_t i = 0; i < n; ++i) {
+        v.push_back(static_cast<int>(i));
+    }
+    return Bench::ns_per_op([&v] {
+        V c(v);
+        Bench::do_not_optimize(c);
+    }, iterations);
+}
+
+}  // namespace
+
+int main()
+{
+    const size_t sizes[] = { 0, 1, 2, 4, 8, 16, 32, 64 };
+
+    std::printf("estd::small_vector<int, %zu> (%zu bytes) vs std::vector<int> (%zu bytes)\n",
+        inline_elements, sizeof(small_vec), sizeof(std_vec));
+
+    Bench::print_header("push_back [ns/container]", "size\tsmall_vector\tstd::vector");
+    for (auto n : sizes) {
+        std::printf("%zu\t%.1f\t\t%.1f\n", n,
+            bench_push_back<small_vec>(n), bench_push_back<std_vec>(n));
+    }
+
+    Bench::print_header("iterate [ns/container]", "size\tsmall_vector\tstd::vector");
+    for (auto n : sizes) {
+        std::printf("%zu\t%.1f\t\t%.1f\n", n,
+            bench_iterate<small_vec>(n), bench_iterate<std_vec>(n));
+    }
+
+    Bench::print_header("copy [ns/container]", "size\tsmall_vector\tstd::vector");
+    for (auto n : sizes) {
+        std::printf("%zu\t%.1f\t\t%.1f\n", n,
+            bench_copy<small_vec>(n), bench_copy<std_vec>(n));
+    }
+    return 0;
+}
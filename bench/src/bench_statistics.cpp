@@ -0,0 +1,38 @@
+// Overhead of estd::statistics_resource_t on an allocate / deallocate pair
+// compared to its upstream, with and without exact peak tracking
+
+#include <cstdio>
+
+#include "memory_resource.h"
+#include "bench.h"
+
+namespace {
+
+constexpr size_t iterations = 2000000;
+
+double bench_pair(estd::poly_alloc_t& a, size_t n)
+{
+    return Bench::ns_per_op([&a, n] {
+        auto p = a.allocate(n);
+        Bench::do_not_optimize(p);
+        a.deallocate(p, n);
+    }, iterations);
+}
+
+}  // namespace
+
+int main()
+{
+    const size_t sizes[] = { 16, 64, 256, 4096 };
+    auto& upstream = estd::default_poly_allocator::instance();
+    estd::statistics_resource_t stats { upstream };
+    estd::statistics_resource_t exact { upstream, 0 };
+
+    Bench::print_header("allocate + deallocate [ns/pair]", "size\tupstream\tstatistics\texact peak");
+    for (auto n : sizes) {
+        std::printf("%zu\t%.1f\t\t%.1f\t\t%.1f\n", n,
+            bench_pair(upstream, n), bench_pair(stats, n), bench_pair(exact, n));
+    }
+    std::printf("\n%s", stats.stats().to_string().c_str());
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Multi-core scaling of a mutex protected shared slab_pool_t with and
+// without an estd::thread_cache_t in front of it, 1..N threads allocating
+// and freeing blocks of mixed sizes
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "memory_resource.h"
+#include "bench.h"
+
+namespace {
+
+constexpr size_t iterations = 200000;
+constexpr size_t live_blocks = 32;
+const size_t sizes[] = { 16, 48, 64, 160 };
+
+// the shared pool allocator every thread contends on
+class locked_pool_t : public estd::poly_alloc_t {
+public:
+    void* allocate(size_t n, const void* = nullptr) override
+    {
+        std::lock_guard<std::mutex> lock { mutex };
+        return pool.allocate(n);
+    }
+
+    void deallocate(void* p, size_t n) noexcept override
+    {
+        std::lock_guard<std::mutex> lock { mutex };
+        pool.deallocate(p, n);
+    }
+
+    size_t max_size() const noexcept override
+    {
+        return pool.max_size();
+    }
+
+    estd::poly_alloc_t* clone(estd::poly_alloc_t& a) const override
+    {
+        return estd::impl::poly_resource_ref<locked_pool_t>::clone_resource_ref(
+            const_cast<locked_pool_t&>(*this), a);
+    }
+
+private:
+    std::mutex mutex;
+    estd::slab_pool_t pool;
+};
+
+void worker(estd::poly_alloc_t& a)
+{
+    void* blocks[live_blocks] = { };
+    for (size_t i = 0; i < iterations; ++i) {
+        auto slot = i % live_blocks;
+        auto n = sizes[slot % 4];
+        if (blocks[slot]) {
+            a.deallocate(blocks[slot], n);
+        }
+        blocks[slot] = a.allocate(n);
+        Bench::do_not_optimize(blocks[slot]);
+    }
+    for (size_t slot = 0; slot < live_blocks; ++slot) {
+        a.deallocate(blocks[slot], sizes[slot % 4]);
+    }
+}
+
+// million allocations per second summed over all threads
+double mops(estd::poly_alloc_t& a, size_t threads)
+{
+    using clock = std::chrono::steady_clock;
+    std::vector<std::thread> workers;
+    auto start = clock::now();
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&a] { worker(a); });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    std::chrono::duration<double, std::micro> elapsed = clock::now() - start;
+    return static_cast<double>(threads * iterations) / elapsed.count();
+}
+
+}  // namespace
+
+int main()
+{
+    auto max_threads = std::max(std::thread::hardware_concurrency(), 4U);
+
+    Bench::print_header("allocate + deallocate [M ops/s, all threads]",
+        "threads\tlocked pool\tthread_cache_t");
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        locked_pool_t locked;
+        locked_pool_t shared;
+        estd::thread_cache_t cached { shared };
+        std::printf("%zu\t%.1f\t\t%.1f\n", threads,
+            mops(locked, threads), mops(cached, threads));
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Latency distribution of single allocations and deallocations of random
+// sizes on a fragmented estd::tlsf_t and on the default std::allocator, the
+// worst case includes preemption of the benchmark thread
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "memory_resource.h"
+#include "bench.h"
+
+namespace {
+
+constexpr size_t region_size = 64 * 1024 * 1024;
+constexpr size_t operations = 1000000;
+constexpr size_t live_blocks = 20000;
+
+struct latency_t {
+    double average;
+    double p999;
+    double worst;
+};
+
+// times every operation of a random allocate / deallocate sequence keeping
+// about live_blocks blocks of 16..4096 bytes alive
+template<class Allocate, class Deallocate>
+latency_t measure(Allocate&& allocate, Deallocate&& deallocate)
+{
+    using clock = std::chrono::steady_clock;
+    std::mt19937 random { 11 };
+    std::vector<std::pair<void*, size_t>> live;
+    std::vector<double> ns;
+    ns.reserve(operations);
+    for (size_t i = 0; i < operations; ++i) {
+        clock::time_point start;
+        if (live.size() < live_blocks && (live.size() < live_blocks / 2 || random() % 2)) {
+            auto n = 16 + random() % 4080;
+            start = clock::now();
+            auto p = allocate(n);
+            live.emplace_back(p, n);
+        } else {
+            auto index = random() % live.size();
+            auto b = live[index];
+            live[index] = live.back();
+            live.pop_back();
+            start = clock::now();
+            deallocate(b.first, b.second);
+        }
+        std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        ns.push_back(elapsed.count());
+    }
+    for (auto& b : live) {
+        deallocate(b.first, b.second);
+    }
+    latency_t l;
+    l.average = std::accumulate(ns.begin(), ns.end(), 0.0) / static_cast<double>(ns.size());
+    std::sort(ns.begin(), ns.end());
+    l.p999 = ns[ns.size() * 999 / 1000];
+    l.worst = ns.back();
+    return l;
+}
+
+void print(const char* name, latency_t l)
+{
+    std::printf("%s\t%.1f\t%.1f\t%.1f\n", name, l.average, l.p999, l.worst);
+}
+
+}  // namespace
+
+int main()
+{
+    estd::mapping_options_t options;
+    options.populate = true;
+    auto region = estd::map_memory(region_size, options);
+    estd::tlsf_t tlsf { region.resource() };
+    std::allocator<uint8_t> a;
+
+    Bench::print_header("allocate / deallocate latency [ns]", "\t\taverage\tp99.9\tworst");
+    print("tlsf_t\t", measure(
+        [&tlsf](size_t n) { return tlsf.allocate(n, 16); },
+        [&tlsf](void* p, size_t n) { tlsf.deallocate(p, n, 16); }));
+    print("std::allocator", measure(
+        [&a](size_t n) { return a.allocate(n); },
+        [&a](void* p, size_t n) { a.deallocate(static_cast<uint8_t*>(p), n); }));
+    return 0;
+}
@@ -24,24 +24,12 @@
 #include <utility>
 #include <type_traits>
 #include <functional>
+#include <cstring>
 #include "memory.h"
 
 namespace estd {
 namespace impl {
 
-template<bool, typename T1, typename T2>
-struct If {
-    using type = T1;
-};
-
-template<typename T1, typename T2>
-struct If<false, T1, T2> {
-    using type = T2;
-};
-
-template<bool b, typename T1, typename T2>
-using If_t = typename If<b, T1, T2>::type;
-
 template<bool b, bool ... B>
 struct And {
     static constexpr bool value = b && And<B...>::value;
@@ -107,6 +95,14 @@ struct IInterface: public IFunction<F...> {
     virtual ~IInterface() = default;
 };
 
+// interface of move only bindings, no cloning in the dispatch table
+template<typename ... F>
+struct IUniqueInterface: public IFunction<F...> {
+
+    virtual IUniqueInterface* move_implementation__(void* dest) noexcept = 0;
+    virtual ~IUniqueInterface() = default;
+};
+
 struct IInterfaceCloningPolicy {
     template<typename ... F>
     static IInterface<F...>* Clone(const IInterface<F...>& from, void* to)
@@ -120,6 +116,12 @@ struct IInterfaceCloningPolicy {
         return from.move_implementation__(to);
     }
 
+    template<typename ... F>
+    static IUniqueInterface<F...>* Move(IUniqueInterface<F...> && from, void* to) noexcept
+    {
+        return from.move_implementation__(to);
+    }
+
 };
 
 template<typename IF, typename Impl, typename ... F>
@@ -137,6 +139,11 @@ struct Binder<IF, Impl, R(Args...), F...> : public Binder<IF, Impl, F...> {
             Binder<IF, Impl, F...>(std::move(i))
     {
     }
+    template<typename ... CArgs>
+    Binder(in_place_type_t<Impl> t, CArgs&&... args) :
+            Binder<IF, Impl, F...>(t, std::forward<CArgs>(args)...)
+    {
+    }
     Binder(const Binder& b) :
             Binder<IF, Impl, F...>(b)
     {
@@ -164,6 +171,11 @@ struct Binder<IF, Impl, void(Args...), F...> : public Binder<IF, Impl, F...> {
             Binder<IF, Impl, F...>(std::move(i))
     {
     }
+    template<typename ... CArgs>
+    Binder(in_place_type_t<Impl> t, CArgs&&... args) :
+            Binder<IF, Impl, F...>(t, std::forward<CArgs>(args)...)
+    {
+    }
     Binder(const Binder& b) :
             Binder<IF, Impl, F...>(b)
     {
@@ -191,6 +203,11 @@ struct Binder<IF, Impl, R(Args...)> : public IF, protected Impl {
             Impl(std::move(i))
     {
     }
+    template<typename ... CArgs>
+    Binder(in_place_type_t<Impl>, CArgs&&... args) :
+            Impl(std::forward<CArgs>(args)...)
+    {
+    }
     Binder(const Binder& b) :
             Impl(b)
     {
@@ -218,6 +235,11 @@ struct Binder<IF, Impl, void(Args...)> : public IF, protected Impl {
             Impl(std::move(i))
     {
     }
+    template<typename ... CArgs>
+    Binder(in_place_type_t<Impl>, CArgs&&... args) :
+            Impl(std::forward<CArgs>(args)...)
+    {
+    }
     Binder(const Binder& b) :
             Impl(b)
     {
@@ -243,6 +265,11 @@ struct BindImpl: public Binder<IF, Impl, F...> {
             Binder<IF, Impl, F...>(std::move(i))
     {
     }
+    template<typename ... CArgs>
+    BindImpl(in_place_type_t<Impl> t, CArgs&&... args) :
+            Binder<IF, Impl, F...>(t, std::forward<CArgs>(args)...)
+    {
+    }
     BindImpl(const BindImpl& b) :
             Binder<IF, Impl, F...>(b)
     {
@@ -264,6 +291,29 @@ struct BindImpl: public Binder<IF, Impl, F...> {
 
 };
 
+template<typename IF, typename Impl, typename ... F>
+struct UniqueBindImpl: public Binder<IF, Impl, F...> {
+    UniqueBindImpl(Impl&&i) :
+            Binder<IF, Impl, F...>(std::move(i))
+    {
+    }
+    template<typename ... CArgs>
+    UniqueBindImpl(in_place_type_t<Impl> t, CArgs&&... args) :
+            Binder<IF, Impl, F...>(t, std::forward<CArgs>(args)...)
+    {
+    }
+    UniqueBindImpl(UniqueBindImpl&& b) :
+            Binder<IF, Impl, F...>(std::move(b))
+    {
+    }
+
+    UniqueBindImpl* move_implementation__(void* dest) noexcept override
+    {
+        return new (dest) UniqueBindImpl(std::move(*this));
+    }
+
+};
+
 template<typename Impl,typename... F>
 struct interface_signature;
 
@@ -282,8 +332,200 @@ struct interface_signature<Impl, R(Args...)> {
     }
 };
 
+// the thunks are called with the address of the object
+struct DirectLocator {
+    template<typename T>
+    static T* get(void* obj) noexcept
+    {
+        return static_cast<T*>(obj);
+    }
+};
+
+// the thunks are called with the address of the sso_storage_t holding
+// the object, its location is known from the size of the object
+template<typename Storage>
+struct StorageLocator {
+    template<typename T>
+    static T* get(void* storage) noexcept
+    {
+        return static_cast<T*>(static_cast<Storage*>(storage)->
+            template get_sized<sizeof(T)>());
+    }
+};
+
+// table of one thunk per signature, overloaded like IFunction
+template<typename Locator, typename ... F>
+struct RefThunks;
+
+template<typename Locator, typename R, typename ... Args, typename ... F>
+struct RefThunks<Locator, R(Args...), F...> : public RefThunks<Locator, F...> {
+    using RefThunks<Locator, F...>::call_function__;
+
+    template<typename T>
+    constexpr explicit RefThunks(in_place_type_t<T> t) noexcept :
+            RefThunks<Locator, F...>(t), thunk { &call<T> }
+    {
+    }
+
+    // thunks of an unbound table throw bad_function_call
+    constexpr explicit RefThunks(in_place_type_t<void> t) noexcept :
+            RefThunks<Locator, F...>(t), thunk { &call_unbound }
+    {
+    }
+
+    R call_function__(void* obj, Args ... args) const
+    {
+        return thunk(obj, static_forward<Args>(args)...);
+    }
+
+private:
+    template<typename T>
+    static R call(void* obj, Args ... args)
+    {
+        return (*Locator::template get<T>(obj))(static_forward<Args>(args)...);
+    }
+
+    static R call_unbound(void*, Args ...)
+    {
+        throw std::bad_function_call {};
+    }
+
+    R (*thunk)(void*, Args...);
+};
+
+template<typename Locator, typename R, typename ... Args>
+struct RefThunks<Locator, R(Args...)> {
+    template<typename T>
+    constexpr explicit RefThunks(in_place_type_t<T>) noexcept :
+            thunk { &call<T> }
+    {
+    }
+
+    constexpr explicit RefThunks(in_place_type_t<void>) noexcept :
+            thunk { &call_unbound }
+    {
+    }
+
+    R call_function__(void* obj, Args ... args) const
+    {
+        return thunk(obj, static_forward<Args>(args)...);
+    }
+
+private:
+    template<typename T>
+    static R call(void* obj, Args ... args)
+    {
+        return (*Locator::template get<T>(obj))(static_forward<Args>(args)...);
+    }
+
+    static R call_unbound(void*, Args ...)
+    {
+        throw std::bad_function_call {};
+    }
+
+    R (*thunk)(void*, Args...);
+};
+
+// one statically initialized thunk table per bound type
+template<typename T, typename ... F>
+struct RefThunksFor {
+    static constexpr RefThunks<DirectLocator, F...> value { in_place_type_t<T> { } };
+};
+
+template<typename T, typename ... F>
+constexpr RefThunks<DirectLocator, F...> RefThunksFor<T, F...>::value;
+
+// Dispatch table of a callable stored without vptr: the call thunks and
+// the functions managing the object's lifetime in a raw storage
+template<typename Storage, typename ... F>
+struct InterfaceTable {
+    template<typename T>
+    constexpr explicit InterfaceTable(in_place_type_t<T> t) noexcept :
+            thunks { t }, clone { &clone_impl<T> },
+            relocate { &relocate_impl<T> }, destroy { &destroy_impl<T> }
+    {
+    }
+
+    // table of the unbound state, its thunks throw bad_function_call
+    constexpr explicit InterfaceTable(in_place_type_t<void> t) noexcept :
+            thunks { t }, clone { &noop_clone },
+            relocate { &noop_relocate }, destroy { &noop_destroy }
+    {
+    }
+
+    RefThunks<StorageLocator<Storage>, F...> thunks;
+    // copy constructs the object at src into dest
+    void (*clone)(const void* src, void* dest);
+    // moves the object at src into dest and destroys the source
+    void (*relocate)(void* src, void* dest) noexcept;
+    void (*destroy)(void* obj) noexcept;
+
+private:
+    template<typename T>
+    static void clone_impl(const void* src, void* dest)
+    {
+        ::new (dest) T(*static_cast<const T*>(src));
+    }
+
+    template<typename T>
+    static void relocate_impl(void* src, void* dest) noexcept
+    {
+        relocate_impl<T>(src, dest, is_trivially_relocatable<T> { });
+    }
+
+    template<typename T>
+    static void relocate_impl(void* src, void* dest, std::true_type) noexcept
+    {
+        std::memcpy(dest, src, sizeof(T));
+    }
+
+    template<typename T>
+    static void relocate_impl(void* src, void* dest, std::false_type) noexcept
+    {
+        ::new (dest) T(std::move(*static_cast<T*>(src)));
+        static_cast<T*>(src)->~T();
+    }
+
+    template<typename T>
+    static void destroy_impl(void* obj) noexcept
+    {
+        static_cast<T*>(obj)->~T();
+    }
+
+    static void noop_clone(const void*, void*)
+    {
+    }
+
+    static void noop_relocate(void*, void*) noexcept
+    {
+    }
+
+    static void noop_destroy(void*) noexcept
+    {
+    }
+};
+
+template<typename T, typename Storage, typename ... F>
+struct InterfaceTableFor {
+    static constexpr InterfaceTable<Storage, F...> value { in_place_type_t<T> { } };
+};
+
+template<typename T, typename Storage, typename ... F>
+constexpr InterfaceTable<Storage, F...> InterfaceTableFor<T, Storage, F...>::value;
+
 }  // namespace impl
 
+// the binder adds only a vptr to the bound implementation
+template<typename IF, typename Impl, typename ... F>
+struct is_trivially_relocatable<impl::BindImpl<IF, Impl, F...>> :
+    public is_trivially_relocatable<Impl> {
+};
+
+template<typename IF, typename Impl, typename ... F>
+struct is_trivially_relocatable<impl::UniqueBindImpl<IF, Impl, F...>> :
+    public is_trivially_relocatable<Impl> {
+};
+
 // Can be used if disambiguation is requried
 template<typename IF, typename T>
 struct function_view_t;
@@ -334,58 +576,141 @@ function_view_t<IF, F> function_view(IF& i)
     return function_view_t<IF, F>(i);
 }
 
-template<class Allocator, typename ... Fs>
-struct interface_t : public impl::interface_signature<interface_t<Allocator,Fs...>,Fs...> {
+// Non-owning reference to any object that can be invoked with each of the
+// signatures in Fs, the referred object must outlive the reference.
+// Consists of the object pointer and a pointer to a static thunk table,
+// calling it costs one indirect call.
+template<typename ... Fs>
+struct interface_ref : public impl::interface_signature<interface_ref<Fs...>, Fs...> {
+
+    using impl::interface_signature<interface_ref, Fs...>::operator();
+
+    template<typename T, typename = std::enable_if_t<
+            !std::is_base_of<interface_ref, std::decay_t<T>>::value> >
+    interface_ref(T&& t) noexcept :
+            obj { const_cast<void*>(static_cast<const void*>(std::addressof(t))) },
+            thunks { &impl::RefThunksFor<std::remove_reference_t<T>, Fs...>::value }
+    {
+    }
+
+    interface_ref(const interface_ref&) noexcept = default;
+    interface_ref& operator =(const interface_ref&) noexcept = default;
+
+    template<typename R, typename ... Args>
+    static R invoke(interface_ref& i, Args&&... args)
+    {
+        return i.thunks->call_function__(i.obj, std::forward<Args>(args)...);
+    }
+
+private:
+    void* obj;
+    const impl::RefThunks<impl::DirectLocator, Fs...>* thunks;
+};
+
+// Type erased holder of any callable that can be invoked with each of the
+// signatures in Fs. Callables up to storage_size pointers (including the
+// vptr of the binding) and alignment are stored inline.
+template<size_t storage_size, size_t alignment, class Allocator, typename ... Fs>
+struct basic_interface_t : public impl::interface_signature<
+    basic_interface_t<storage_size, alignment, Allocator, Fs...>, Fs...> {
 
     using if_t = impl::IInterface<Fs...>;
-    using impl::interface_signature<interface_t<Allocator,Fs...>, Fs...>::operator();
-    static constexpr size_t max_storage_size = 4;
+    using impl::interface_signature<basic_interface_t, Fs...>::operator();
+    static constexpr size_t max_storage_size = storage_size;
     using poly_obj_storage =
             polymorphic_obj_storage_t<
                 if_t,
                 impl::IInterfaceCloningPolicy,
                 max_storage_size,
-                alignof(::std::max_align_t),
+                alignment,
                 Allocator
                 >;
 
-    interface_t() = default;
+    template<typename T>
+    using binding_t = impl::BindImpl<if_t, T, Fs...>;
+
+    // storage size (in pointer size) that holds any of Ts inline
+    template<typename ... Ts>
+    static constexpr size_t inline_size_for() noexcept
+    {
+        return (::std::max({ sizeof(binding_t<Ts>)... }) + sizeof(void*) - 1) /
+            sizeof(void*);
+    }
+
+    template<typename ... Ts>
+    static constexpr size_t inline_alignment_for() noexcept
+    {
+        return ::std::max({ alignof(binding_t<Ts>)... });
+    }
+
+    // the same interface with the minimal inline storage for Ts
+    template<typename ... Ts>
+    using fitted_for = basic_interface_t<inline_size_for<Ts...>(),
+        inline_alignment_for<Ts...>(), Allocator, Fs...>;
+
+    basic_interface_t() = default;
 
     template<typename T, typename = std::enable_if_t<
-            !std::is_base_of<interface_t, std::decay_t<T>>::value> >
-    explicit interface_t(T&& t) :
-            obj { impl::BindImpl<if_t, std::decay_t<T>, Fs...>(
-                    std::forward<T>(t)) }
+            !std::is_base_of<basic_interface_t, std::decay_t<T>>::value &&
+            !impl::is_in_place_type<std::decay_t<T>>::value> >
+    explicit basic_interface_t(T&& t) :
+            basic_interface_t(in_place_type_t<std::decay_t<T>> { }, std::forward<T>(t))
     {
     }
 
     template<class A,typename T, typename = std::enable_if_t<
-            !std::is_base_of<interface_t, std::decay_t<T>>::value> >
-    explicit interface_t(std::allocator_arg_t,A&& a, T&& t) :
-            obj {std::allocator_arg,std::forward<A>(a),
-                 impl::BindImpl<if_t, std::decay_t<T>, Fs...>(std::forward<T>(t)) }
+            !std::is_base_of<basic_interface_t, std::decay_t<T>>::value> >
+    explicit basic_interface_t(std::allocator_arg_t,A&& a, T&& t) :
+            basic_interface_t(std::allocator_arg, std::forward<A>(a),
+                in_place_type_t<std::decay_t<T>> { }, std::forward<T>(t))
+    {
+    }
+
+    // binds a T constructed from args directly in the storage
+    template<typename T, typename ... Args>
+    explicit basic_interface_t(in_place_type_t<T>, Args&&... args) :
+            obj { in_place_type_t<binding_t<T>> { }, in_place_type_t<T> { },
+                    std::forward<Args>(args)... }
     {
     }
 
-    interface_t(const interface_t& i) = default;
-    interface_t& operator =(const interface_t& i) = default;
-    interface_t(interface_t&& i)
+    template<class A, typename T, typename ... Args>
+    explicit basic_interface_t(std::allocator_arg_t, A&& a, in_place_type_t<T>,
+        Args&&... args) :
+            obj { std::allocator_arg, std::forward<A>(a),
+                    in_place_type_t<binding_t<T>> { }, in_place_type_t<T> { },
+                    std::forward<Args>(args)... }
+    {
+    }
+
+    basic_interface_t(const basic_interface_t& i) = default;
+    basic_interface_t& operator =(const basic_interface_t& i) = default;
+    basic_interface_t(basic_interface_t&& i)
         noexcept(std::is_nothrow_move_constructible<poly_obj_storage>::value) = default;
-    interface_t& operator =(interface_t&& i)
+    basic_interface_t& operator =(basic_interface_t&& i)
         noexcept(std::is_nothrow_move_assignable<poly_obj_storage>::value) = default;
 
-    ~interface_t() = default;
+    ~basic_interface_t() = default;
+
+    // rebinds the interface to a T constructed from args in place,
+    // the storage is reused if the size of the binding matches
+    template<typename T, typename ... Args>
+    void emplace(Args&&... args)
+    {
+        obj.template emplace<binding_t<T>>(in_place_type_t<T> { },
+            std::forward<Args>(args)...);
+    }
 
     template<typename R, typename ... Args>
     static std::enable_if_t<!std::is_same<void, R>::value, R> invoke(
-        interface_t& i, Args&&... args)
+        basic_interface_t& i, Args&&... args)
     {
         i.check();
         return i.obj->call_function__(std::forward<Args>(args)...);
     }
 
     template<typename R, typename ... Args>
-    static std::enable_if_t<std::is_same<void, R>::value> invoke(interface_t& i,Args&&... args)
+    static std::enable_if_t<std::is_same<void, R>::value> invoke(basic_interface_t& i,Args&&... args)
     {
         i.check();
         i.obj->call_function__(std::forward<Args>(args)...);
@@ -401,11 +726,344 @@ private:
     poly_obj_storage obj;
 };
 
+template<size_t s, size_t a, class A, typename ... Fs>
+constexpr size_t basic_interface_t<s, a, A, Fs...>::max_storage_size;
+
+// Move only counterpart of basic_interface_t, can hold callables that are
+// not copyable (e.g. capturing a unique_ptr)
+template<size_t storage_size, size_t alignment, class Allocator, typename ... Fs>
+struct basic_unique_interface_t : public impl::interface_signature<
+    basic_unique_interface_t<storage_size, alignment, Allocator, Fs...>, Fs...> {
+
+    using if_t = impl::IUniqueInterface<Fs...>;
+    using impl::interface_signature<basic_unique_interface_t, Fs...>::operator();
+    static constexpr size_t max_storage_size = storage_size;
+    using poly_obj_storage =
+            polymorphic_obj_storage_t<
+                if_t,
+                impl::IInterfaceCloningPolicy,
+                max_storage_size,
+                alignment,
+                Allocator
+                >;
+
+    template<typename T>
+    using binding_t = impl::UniqueBindImpl<if_t, T, Fs...>;
+
+    // storage size (in pointer size) that holds any of Ts inline
+    template<typename ... Ts>
+    static constexpr size_t inline_size_for() noexcept
+    {
+        return (::std::max({ sizeof(binding_t<Ts>)... }) + sizeof(void*) - 1) /
+            sizeof(void*);
+    }
+
+    template<typename ... Ts>
+    static constexpr size_t inline_alignment_for() noexcept
+    {
+        return ::std::max({ alignof(binding_t<Ts>)... });
+    }
+
+    // the same interface with the minimal inline storage for Ts
+    template<typename ... Ts>
+    using fitted_for = basic_unique_interface_t<inline_size_for<Ts...>(),
+        inline_alignment_for<Ts...>(), Allocator, Fs...>;
+
+    basic_unique_interface_t() = default;
+
+    template<typename T, typename = std::enable_if_t<
+            !std::is_base_of<basic_unique_interface_t, std::decay_t<T>>::value &&
+            !impl::is_in_place_type<std::decay_t<T>>::value> >
+    explicit basic_unique_interface_t(T&& t) :
+            basic_unique_interface_t(in_place_type_t<std::decay_t<T>> { },
+                std::forward<T>(t))
+    {
+    }
+
+    template<class A,typename T, typename = std::enable_if_t<
+            !std::is_base_of<basic_unique_interface_t, std::decay_t<T>>::value> >
+    explicit basic_unique_interface_t(std::allocator_arg_t,A&& a, T&& t) :
+            basic_unique_interface_t(std::allocator_arg, std::forward<A>(a),
+                in_place_type_t<std::decay_t<T>> { }, std::forward<T>(t))
+    {
+    }
+
+    // binds a T constructed from args directly in the storage
+    template<typename T, typename ... Args>
+    explicit basic_unique_interface_t(in_place_type_t<T>, Args&&... args) :
+            obj { in_place_type_t<binding_t<T>> { }, in_place_type_t<T> { },
+                    std::forward<Args>(args)... }
+    {
+    }
+
+    template<class A, typename T, typename ... Args>
+    explicit basic_unique_interface_t(std::allocator_arg_t, A&& a,
+        in_place_type_t<T>, Args&&... args) :
+            obj { std::allocator_arg, std::forward<A>(a),
+                    in_place_type_t<binding_t<T>> { }, in_place_type_t<T> { },
+                    std::forward<Args>(args)... }
+    {
+    }
+
+    basic_unique_interface_t(const basic_unique_interface_t& i) = delete;
+    basic_unique_interface_t& operator =(const basic_unique_interface_t& i) = delete;
+    basic_unique_interface_t(basic_unique_interface_t&& i)
+        noexcept(std::is_nothrow_move_constructible<poly_obj_storage>::value) = default;
+    basic_unique_interface_t& operator =(basic_unique_interface_t&& i)
+        noexcept(std::is_nothrow_move_assignable<poly_obj_storage>::value) = default;
+
+    ~basic_unique_interface_t() = default;
+
+    // rebinds the interface to a T constructed from args in place,
+    // the storage is reused if the size of the binding matches
+    template<typename T, typename ... Args>
+    void emplace(Args&&... args)
+    {
+        obj.template emplace<binding_t<T>>(in_place_type_t<T> { },
+            std::forward<Args>(args)...);
+    }
+
+    template<typename R, typename ... Args>
+    static std::enable_if_t<!std::is_same<void, R>::value, R> invoke(
+        basic_unique_interface_t& i, Args&&... args)
+    {
+        i.check();
+        return i.obj->call_function__(std::forward<Args>(args)...);
+    }
+
+    template<typename R, typename ... Args>
+    static std::enable_if_t<std::is_same<void, R>::value> invoke(
+        basic_unique_interface_t& i, Args&&... args)
+    {
+        i.check();
+        i.obj->call_function__(std::forward<Args>(args)...);
+    }
+
+private:
+    void check()
+    {
+        if (!obj)
+            throw std::bad_function_call {};
+    }
+
+    poly_obj_storage obj;
+};
+
+template<size_t s, size_t a, class A, typename ... Fs>
+constexpr size_t basic_unique_interface_t<s, a, A, Fs...>::max_storage_size;
+
+// Alternative to basic_interface_t that stores the callable without a vptr.
+// The interface refers to a static table of function pointers per bound
+// type, so a call is a single indirect call and the unbound state is
+// represented by a table that throws bad_function_call.
+template<size_t storage_size, size_t alignment, class Allocator, typename ... Fs>
+struct basic_table_interface_t : public impl::interface_signature<
+    basic_table_interface_t<storage_size, alignment, Allocator, Fs...>, Fs...> {
+
+    using impl::interface_signature<basic_table_interface_t, Fs...>::operator();
+    static constexpr size_t max_storage_size = storage_size;
+    using storage_t = sso_storage_t<max_storage_size, alignment, Allocator>;
+    using table_t = impl::InterfaceTable<storage_t, Fs...>;
+
+    // storage size (in pointer size) that holds any of Ts inline
+    template<typename ... Ts>
+    static constexpr size_t inline_size_for() noexcept
+    {
+        return (::std::max({ sizeof(Ts)... }) + sizeof(void*) - 1) /
+            sizeof(void*);
+    }
+
+    template<typename ... Ts>
+    static constexpr size_t inline_alignment_for() noexcept
+    {
+        return ::std::max({ alignof(Ts)... });
+    }
+
+    // the same interface with the minimal inline storage for Ts
+    template<typename ... Ts>
+    using fitted_for = basic_table_interface_t<inline_size_for<Ts...>(),
+        inline_alignment_for<Ts...>(), Allocator, Fs...>;
+
+    basic_table_interface_t() noexcept :
+            storage { }, table { unbound() }
+    {
+    }
+
+    template<typename T, typename = std::enable_if_t<
+            !std::is_base_of<basic_table_interface_t, std::decay_t<T>>::value &&
+            !impl::is_in_place_type<std::decay_t<T>>::value> >
+    explicit basic_table_interface_t(T&& t) :
+            basic_table_interface_t(in_place_type_t<std::decay_t<T>> { },
+                std::forward<T>(t))
+    {
+    }
+
+    template<class A,typename T, typename = std::enable_if_t<
+            !std::is_base_of<basic_table_interface_t, std::decay_t<T>>::value> >
+    explicit basic_table_interface_t(std::allocator_arg_t,A&& a, T&& t) :
+            basic_table_interface_t(std::allocator_arg, std::forward<A>(a),
+                in_place_type_t<std::decay_t<T>> { }, std::forward<T>(t))
+    {
+    }
+
+    // constructs a T from args directly in the storage
+    template<typename T, typename ... Args>
+    explicit basic_table_interface_t(in_place_type_t<T>, Args&&... args) :
+            storage { sizeof(T) }, table { unbound() }
+    {
+        construct<T>(std::forward<Args>(args)...);
+    }
+
+    template<class A, typename T, typename ... Args>
+    explicit basic_table_interface_t(std::allocator_arg_t, A&& a,
+        in_place_type_t<T>, Args&&... args) :
+            storage { std::allocator_arg, std::forward<A>(a), sizeof(T) },
+            table { unbound() }
+    {
+        construct<T>(std::forward<Args>(args)...);
+    }
+
+    basic_table_interface_t(const basic_table_interface_t& rhs) :
+            storage { rhs.storage }, table { unbound() }
+    {
+        rhs.table->clone(rhs.storage.get(), storage.get());
+        table = rhs.table;
+    }
+
+    // a moved from interface is unbound
+    basic_table_interface_t(basic_table_interface_t&& rhs) noexcept :
+            storage { std::move(rhs.storage) }, table { rhs.table }
+    {
+        // heap storage is taken over, inline objects have to be moved
+        if (storage.size() > 0 && storage.size() <= storage.max_size()) {
+            table->relocate(rhs.storage.get(), storage.get());
+        }
+        rhs.table = unbound();
+    }
+
+    // provides basic guarantee
+    basic_table_interface_t& operator =(const basic_table_interface_t& rhs)
+    {
+        if (this != &rhs) {
+            reset();
+            storage = rhs.storage;
+            rhs.table->clone(rhs.storage.get(), storage.get());
+            table = rhs.table;
+        }
+        return *this;
+    }
+
+    basic_table_interface_t& operator =(basic_table_interface_t&& rhs)
+        noexcept(std::is_nothrow_move_assignable<storage_t>::value)
+    {
+        if (this != &rhs) {
+            reset();
+            obtain(std::move(rhs));
+        }
+        return *this;
+    }
+
+    ~basic_table_interface_t()
+    {
+        table->destroy(storage.get());
+    }
+
+    // rebinds the interface to a T constructed from args in place, the
+    // storage is reused if T is placed the same way (inline or on the heap)
+    // and fits its usable capacity
+    template<typename T, typename ... Args>
+    void emplace(Args&&... args)
+    {
+        reset();
+        if (!storage ||
+            (sizeof(T) <= storage.max_size()) != (storage.size() <= storage.max_size()) ||
+            !storage.try_expand_in_place(sizeof(T))) {
+            storage.deallocate();
+            storage.allocate(sizeof(T));
+        }
+        construct<T>(std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return table != unbound();
+    }
+
+    template<typename R, typename ... Args>
+    static R invoke(basic_table_interface_t& i, Args&&... args)
+    {
+        return i.table->thunks.call_function__(&i.storage,
+            std::forward<Args>(args)...);
+    }
+
+private:
+    static const table_t* unbound() noexcept
+    {
+        return &impl::InterfaceTableFor<void, storage_t, Fs...>::value;
+    }
+
+    // precondition: storage is allocated with sizeof(T) bytes, unbound
+    template<typename T, typename ... Args>
+    void construct(Args&&... args)
+    {
+        static_assert(storage_t::is_alignment_ok(
+                        impl::alignment_t<alignof(T)> {}),
+                "T is not properly aligned");
+        ::new (storage.get()) T(std::forward<Args>(args)...);
+        table = &impl::InterfaceTableFor<T, storage_t, Fs...>::value;
+    }
+
+    // precondition: unbound
+    void obtain(basic_table_interface_t&& rhs)
+    {
+        auto src = rhs.storage.get();
+        storage = std::move(rhs.storage);
+        // inline storage or reallocation with this allocator
+        if (storage.get() != src) {
+            rhs.table->relocate(src, storage.get());
+        }
+        table = rhs.table;
+        rhs.table = unbound();
+    }
+
+    void reset() noexcept
+    {
+        table->destroy(storage.get());
+        table = unbound();
+    }
+
+    //////////////////////////
+    ///// member variables
+    /////////////////////////
+    storage_t storage;
+    const table_t* table;
+};
+
+template<size_t s, size_t a, class A, typename ... Fs>
+constexpr size_t basic_table_interface_t<s, a, A, Fs...>::max_storage_size;
+
+template<class Allocator, typename ... Fs>
+using interface_t = basic_interface_t<4, alignof(::std::max_align_t), Allocator, Fs...>;
+
 template<typename... F>
 using interface = interface_t<std::allocator<uint8_t>,F...>;
 
 template<typename F>
-using function = interface_t<F>;
+using function = interface<F>;
+
+template<class Allocator, typename ... Fs>
+using unique_interface_t =
+    basic_unique_interface_t<4, alignof(::std::max_align_t), Allocator, Fs...>;
+
+template<typename... F>
+using unique_interface = unique_interface_t<std::allocator<uint8_t>,F...>;
+
+template<class Allocator, typename ... Fs>
+using table_interface_t =
+    basic_table_interface_t<4, alignof(::std::max_align_t), Allocator, Fs...>;
+
+template<typename... F>
+using table_interface = table_interface_t<std::allocator<uint8_t>,F...>;
 
 
 
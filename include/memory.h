@@ -29,10 +29,36 @@
 #include <algorithm>
 #include <utility>
 #include <functional>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
 
 namespace estd {
 
+// disambiguation tag for constructing an object of type T in place
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+template<typename T>
+using in_place_type_t = ::std::in_place_type_t<T>;
+#else
+template<typename T>
+struct in_place_type_t {
+    explicit in_place_type_t() = default;
+};
+#endif
+
+template<typename T>
+constexpr in_place_type_t<T> in_place_type { };
+
 namespace impl {
+template<typename T>
+struct is_in_place_type : public ::std::false_type {
+};
+
+template<typename T>
+struct is_in_place_type<in_place_type_t<T>> : public ::std::true_type {
+};
+
 template<size_t P, size_t N>
 struct is_power_of;
 
@@ -53,6 +79,19 @@ struct is_power_of<P, 0> {
     static constexpr bool value = false;
 };
 
+template<bool, typename T1, typename T2>
+struct If {
+    using type = T1;
+};
+
+template<typename T1, typename T2>
+struct If<false, T1, T2> {
+    using type = T2;
+};
+
+template<bool b, typename T1, typename T2>
+using If_t = typename If<b, T1, T2>::type;
+
 template<typename... Ts>
 struct AndType;
 
@@ -190,12 +229,369 @@ static inline void* aligned_heap_addr(void* ptr,size_t alignment) noexcept
                     *alignment);
 }
 
+// detects the allocate(n, alignment) / deallocate(p, n, alignment)
+// extension on byte allocators
+template<typename A>
+struct has_aligned_allocate {
+private:
+    template<typename AA>
+    static auto test(AA& a) -> decltype(
+        a.deallocate(a.allocate(size_t { }, size_t { }), size_t { }, size_t { }),
+        ::std::true_type { });
+    static ::std::false_type test(...);
+public:
+    using type = decltype(test(::std::declval<A&>()));
+    static constexpr bool value = type::value;
+};
+
+static inline void* aligned_new(size_t n, size_t alignment)
+{
+#if defined(__cpp_aligned_new)
+    return ::operator new(n, ::std::align_val_t(alignment));
+#elif defined(_MSC_VER)
+    auto p = ::_aligned_malloc(n, alignment);
+    if (!p) throw ::std::bad_alloc {};
+    return p;
+#else
+    // size has to be an integral multiple of alignment
+    auto p = ::aligned_alloc(alignment, (n + alignment - 1) / alignment * alignment);
+    if (!p) throw ::std::bad_alloc {};
+    return p;
+#endif
+}
+
+static inline void aligned_delete(void* p, size_t alignment) noexcept
+{
+#if defined(__cpp_aligned_new)
+    ::operator delete(p, ::std::align_val_t(alignment));
+#elif defined(_MSC_VER)
+    (void)alignment;
+    ::_aligned_free(p);
+#else
+    (void)alignment;
+    ::free(p);
+#endif
+}
+
+template<typename P>
+struct allocation_result {
+    P ptr;
+    size_t count;
+};
+
+// detects the allocate_at_least(n) extension, result has to provide
+// ptr and count members like std::allocation_result
+template<typename A>
+struct has_allocate_at_least {
+private:
+    template<typename AA>
+    static auto test(AA& a) -> decltype(
+        a.allocate_at_least(size_t { }).ptr,
+        a.allocate_at_least(size_t { }).count,
+        ::std::true_type { });
+    static ::std::false_type test(...);
+public:
+    using type = decltype(test(::std::declval<A&>()));
+    static constexpr bool value = type::value;
+};
+
+// detects the try_expand(p, n, new_n) extension that grows an allocation
+// in place if possible
+template<typename A>
+struct has_try_expand {
+private:
+    template<typename AA>
+    static auto test(AA& a) -> decltype(
+        static_cast<bool>(a.try_expand(
+            ::std::declval<typename ::std::allocator_traits<AA>::pointer>(),
+            size_t { }, size_t { })),
+        ::std::true_type { });
+    static ::std::false_type test(...);
+public:
+    using type = decltype(test(::std::declval<A&>()));
+    static constexpr bool value = type::value;
+};
+
+template<typename A>
+allocation_result<typename ::std::allocator_traits<A>::pointer>
+allocate_at_least(A& a, size_t n, ::std::true_type)
+{
+    auto r = a.allocate_at_least(n);
+    return { r.ptr, r.count };
+}
+
+template<typename A>
+allocation_result<typename ::std::allocator_traits<A>::pointer>
+allocate_at_least(A& a, size_t n, ::std::false_type)
+{
+    return { a.allocate(n), n };
+}
+
+template<typename A>
+bool try_expand(A& a, typename ::std::allocator_traits<A>::pointer p,
+    size_t n, size_t new_n, ::std::true_type)
+{
+    return a.try_expand(p, n, new_n);
+}
+
+template<typename A>
+bool try_expand(A&, typename ::std::allocator_traits<A>::pointer,
+    size_t, size_t, ::std::false_type) noexcept
+{
+    return false;
+}
+
+// Heap allocation strategies of sso_storage_t, overhead is the number of
+// bytes allocated on top of the requested size
+
+// allocator result is aligned by allocating +alignment bytes
+struct PaddedHeapAllocation {
+    static constexpr size_t overhead(size_t alignment) noexcept
+    {
+        return alignment;
+    }
+
+    template<typename A>
+    static typename ::std::allocator_traits<A>::pointer allocate(A& a, size_t n, size_t)
+    {
+        return a.allocate(n);
+    }
+
+    template<typename A>
+    static allocation_result<typename ::std::allocator_traits<A>::pointer>
+    allocate_at_least(A& a, size_t n, size_t)
+    {
+        return impl::allocate_at_least(a, n, typename has_allocate_at_least<A>::type {});
+    }
+
+    template<typename A>
+    static bool try_expand(A& a, typename ::std::allocator_traits<A>::pointer p,
+        size_t n, size_t new_n, size_t)
+    {
+        return impl::try_expand(a, p, n, new_n, typename has_try_expand<A>::type {});
+    }
+
+    template<typename A>
+    static void deallocate(A& a, typename ::std::allocator_traits<A>::pointer p,
+        size_t n, size_t) noexcept
+    {
+        a.deallocate(p, n);
+    }
+};
+
+// allocator result is suitably aligned without any extra effort
+struct PlainHeapAllocation : public PaddedHeapAllocation {
+    static constexpr size_t overhead(size_t) noexcept
+    {
+        return 0;
+    }
+};
+
+// allocator provides the allocate(n, alignment) extension
+struct AllocatorAlignedHeapAllocation {
+    static constexpr size_t overhead(size_t) noexcept
+    {
+        return 0;
+    }
+
+    template<typename A>
+    static typename ::std::allocator_traits<A>::pointer allocate(A& a, size_t n,
+        size_t alignment)
+    {
+        return a.allocate(n, alignment);
+    }
+
+    template<typename A>
+    static allocation_result<typename ::std::allocator_traits<A>::pointer>
+    allocate_at_least(A& a, size_t n, size_t alignment)
+    {
+        return { a.allocate(n, alignment), n };
+    }
+
+    template<typename A>
+    static bool try_expand(A& a, typename ::std::allocator_traits<A>::pointer p,
+        size_t n, size_t new_n, size_t)
+    {
+        return impl::try_expand(a, p, n, new_n, typename has_try_expand<A>::type {});
+    }
+
+    template<typename A>
+    static void deallocate(A& a, typename ::std::allocator_traits<A>::pointer p,
+        size_t n, size_t alignment) noexcept
+    {
+        a.deallocate(p, n, alignment);
+    }
+};
+
+// std::allocator is bypassed for over-aligned requests
+struct NewAlignedHeapAllocation {
+    static constexpr size_t overhead(size_t) noexcept
+    {
+        return 0;
+    }
+
+    template<typename A>
+    static typename ::std::allocator_traits<A>::pointer allocate(A&, size_t n,
+        size_t alignment)
+    {
+        return static_cast<typename ::std::allocator_traits<A>::pointer>(
+            aligned_new(n, alignment));
+    }
+
+    template<typename A>
+    static allocation_result<typename ::std::allocator_traits<A>::pointer>
+    allocate_at_least(A& a, size_t n, size_t alignment)
+    {
+        return { allocate(a, n, alignment), n };
+    }
+
+    template<typename A>
+    static bool try_expand(A&, typename ::std::allocator_traits<A>::pointer,
+        size_t, size_t, size_t) noexcept
+    {
+        return false;
+    }
+
+    template<typename A>
+    static void deallocate(A&, typename ::std::allocator_traits<A>::pointer p,
+        size_t, size_t alignment) noexcept
+    {
+        aligned_delete(p, alignment);
+    }
+};
+
+template<typename A, size_t alignment>
+struct heap_allocation {
+    using type = If_t<
+        has_aligned_allocate<A>::value,
+        AllocatorAlignedHeapAllocation,
+        PaddedHeapAllocation>;
+};
+
+template<size_t alignment>
+struct heap_allocation<::std::allocator<::std::uint8_t>, alignment> {
+    using type = If_t<
+        (alignment <= alignof(::std::max_align_t)),
+        PlainHeapAllocation,
+        NewAlignedHeapAllocation>;
+};
+
+template<typename A, size_t alignment>
+using heap_allocation_t = typename heap_allocation<A, alignment>::type;
+
 }  //namespace impl
 
+// Types that can be relocated by a bytewise copy, without calling the move
+// constructor and the destructor. Can be specialized for types that are
+// not trivially copyable but do not depend on their own address.
+template<typename T>
+struct is_trivially_relocatable : public ::std::is_trivially_copyable<T> {
+};
+
+// Keeps the inline buffer, the heap pointer and the size as separate
+// members, inline buffer is zeroed on construction. This is the original
+// sso_storage_t layout.
+struct SplitLayoutPolicy {
+    template<size_t max_size, size_t alignment>
+    struct layout {
+        layout() noexcept : storage { }, heap_storage { }, size_ { }
+        {
+        }
+
+        ::std::uint8_t* inline_addr() noexcept
+        {
+            return &*storage.begin();
+        }
+
+        void* inline_or_null() noexcept
+        {
+            return size_ > 0 ? inline_addr() : nullptr;
+        }
+
+        void reset() noexcept
+        {
+            heap_storage = nullptr;
+            size_ = 0;
+        }
+
+        void swap(layout& rhs) noexcept
+        {
+            using std::swap;
+            swap(heap_storage, rhs.heap_storage);
+            swap(size_, rhs.size_);
+        }
+
+        ::std::array<::std::uint8_t, max_size> storage alignas(alignment);
+        // storing in union was considered, but this results in cleaner
+        // and more correct swap logic
+        ::std::uint8_t* heap_storage;
+        size_t size_;
+    };
+
+    // inline bytes are left in place when the heap pointer is swapped
+    static constexpr bool inline_stable_on_swap = true;
+};
+
+// Overlays the heap pointer on the inline buffer and leaves the inline
+// bytes uninitialized on construction, only the size is written.
+// Swapping an inline and a heap allocated storage overwrites the
+// (inaccessible) inline bytes of the previously inline allocated side.
+struct UnionLayoutPolicy {
+    template<size_t max_size, size_t alignment>
+    struct layout {
+        static_assert(max_size >= sizeof(::std::uint8_t*),
+            "inline buffer can not hold a heap pointer");
+
+        layout() noexcept : size_ { }
+        {
+        }
+
+        ::std::uint8_t* inline_addr() noexcept
+        {
+            return storage;
+        }
+
+        // branch free: null if nothing is allocated
+        void* inline_or_null() noexcept
+        {
+            return reinterpret_cast<void*>(
+                reinterpret_cast<uintptr_t>(inline_addr()) &
+                (uintptr_t { 0 } - static_cast<uintptr_t>(size_ != 0)));
+        }
+
+        void reset() noexcept
+        {
+            size_ = 0;
+        }
+
+        void swap(layout& rhs) noexcept
+        {
+            using std::swap;
+            if (size_ > max_size && rhs.size_ > max_size) {
+                swap(heap_storage, rhs.heap_storage);
+            } else if (size_ > max_size) {
+                rhs.heap_storage = heap_storage;
+            } else if (rhs.size_ > max_size) {
+                heap_storage = rhs.heap_storage;
+            }
+            swap(size_, rhs.size_);
+        }
+
+        union {
+            alignas(alignment) ::std::uint8_t storage[max_size];
+            ::std::uint8_t* heap_storage;
+        };
+        size_t size_;
+    };
+
+    static constexpr bool inline_stable_on_swap = false;
+};
+
 template<
     size_t storage_size = 4, // in pointer size
     size_t alignment_ = alignof(::std::max_align_t),
-    class Allocator = ::std::allocator<uint8_t>
+    class Allocator = ::std::allocator<uint8_t>,
+    class LayoutPolicy = SplitLayoutPolicy
 >
 class sso_storage_t: private Allocator {
 public:
@@ -207,9 +603,14 @@ public:
 
     static_assert(impl::is_power_of<2,alignment>::value,"alignment is not a power of 2");
 
+    using layout_policy = LayoutPolicy;
+    using layout_type = typename layout_policy::template layout<max_size_, alignment>;
+
     static_assert(::std::is_same<typename Allocator::value_type, uint8_t>::value,
         "obj_storage_t requires a byte allocator");
 
+    using heap_allocation = impl::heap_allocation_t<Allocator, alignment>;
+
     using allocator_type = Allocator;
     using allocator_traits = ::std::allocator_traits<allocator_type>;
     using propagate_on_container_move_assignment = 
@@ -228,19 +629,26 @@ public:
     static constexpr bool swap_noexcept =
             impl::OrType_t<pocs,impl::allocator_is_always_equal_t<allocator_type>>::value;
 
-    sso_storage_t() :
-            storage { }, heap_storage{}, size_ { }
+    sso_storage_t() noexcept(::std::is_nothrow_default_constructible<allocator_type>::value) :
+            storage { }
     {
     }
 
     template<typename A> 
     sso_storage_t(::std::allocator_arg_t, A&& a) :
-        Allocator(::std::forward<A>(a)), storage { }, heap_storage{}, size_ { }
+        Allocator(::std::forward<A>(a)), storage { }
     {
     }
     
     explicit sso_storage_t(size_t n) :
-            storage { }, heap_storage{},size_ { }
+            storage { }
+    {
+        allocate(n);
+    }
+
+    template<typename A>
+    sso_storage_t(::std::allocator_arg_t, A&& a, size_t n) :
+        Allocator(::std::forward<A>(a)), storage { }
     {
         allocate(n);
     }
@@ -248,7 +656,7 @@ public:
     sso_storage_t(const sso_storage_t& rhs) :
         Allocator(
                 allocator_traits::select_on_container_copy_construction(
-                            rhs.get_allocator())), storage { },heap_storage{}, size_ { }
+                            rhs.get_allocator())), storage { }
     {
         if (rhs.size() > 0 && rhs.size() <= rhs.max_size()) {
             allocate_inline(rhs.size());
@@ -258,7 +666,7 @@ public:
     }
 
     sso_storage_t(sso_storage_t&& rhs) noexcept
-    : Allocator(::std::move(rhs)), storage{}, heap_storage {}, size_ {}
+    : Allocator(::std::move(rhs)), storage{}
     {
         static_assert(::std::is_nothrow_move_constructible<allocator_type>::value,
             "allocator_type is not nothrow_move_constructible");
@@ -291,13 +699,62 @@ public:
         }
     }
 
+    // Grows the allocation to at least n usable bytes. Inline storage is
+    // migrated to the heap, heap storage is expanded in place if the
+    // allocator supports it or moved to a new heap block otherwise.
+    // relocate(void* dest, void* src) has to transfer the contents, if it
+    // throws the storage is left unchanged. Shrinking is a no-op.
+    // Returns the usable capacity after reallocation.
+    template<typename Relocate>
+    size_t reallocate(size_t n, Relocate&& relocate)
+    {
+        if (storage.size_ == 0) {
+            allocate(n);
+        } else if (!try_expand_in_place(n)) {
+            reallocate_with_allocator(n, relocate);
+        }
+        return capacity();
+    }
+
+    // copies the contents bytewise on reallocation
+    size_t reallocate(size_t n)
+    {
+        return reallocate(n, [this](void* dest, void* src) noexcept {
+            ::std::memcpy(dest, src, capacity());
+        });
+    }
+
+    // Returns true if the current allocation can hold at least n bytes
+    // after the call, never moves the contents.
+    bool try_expand_in_place(size_t n)
+    {
+        if (storage.size_ == 0) {
+            return false;
+        }
+        if (storage.size_ <= max_size_) {
+            if (n > max_size_) return false;
+            storage.size_ = ::std::max(storage.size_, n);
+            return true;
+        }
+        const auto raw_size = n + heap_allocation::overhead(alignment);
+        if (raw_size <= storage.size_) {
+            return true;
+        }
+        if (heap_allocation::try_expand(get_allocator(), storage.heap_storage,
+                storage.size_, raw_size, alignment)) {
+            storage.size_ = raw_size;
+            return true;
+        }
+        return false;
+    }
+
     void deallocate() noexcept
     {
-        if (size_ > max_size_) {
-            this->allocator_type::deallocate(heap_storage, size_);
-            heap_storage = nullptr;
+        if (storage.size_ > max_size_) {
+            heap_allocation::deallocate(get_allocator(), storage.heap_storage,
+                storage.size_, alignment);
         }
-        size_ = 0;
+        storage.reset();
     }
 
     ~sso_storage_t()
@@ -307,12 +764,12 @@ public:
 
     operator bool ()const noexcept
     {
-        return size_ != 0;
+        return storage.size_ != 0;
     }
 
     size_t size()const noexcept
     {
-        return size_;
+        return storage.size_;
     }
 
     static constexpr size_t max_size()
@@ -320,9 +777,21 @@ public:
         return max_size_;
     }
 
+    // number of usable bytes, at least the requested allocation size
+    size_t capacity()const noexcept
+    {
+        if (storage.size_ == 0) {
+            return 0;
+        } else if (storage.size_ <= max_size_) {
+            return max_size_;
+        } else {
+            return storage.size_ - heap_allocation::overhead(alignment);
+        }
+    }
+
     void* get_checked()
     {
-        if(size_ == 0) {
+        if(storage.size_ == 0) {
             throw ::std::runtime_error("accessing unallocated storage");
         }
         return get();
@@ -330,15 +799,27 @@ public:
 
     void* get() noexcept
     {
-        if (size_ > 0 && size_ <= max_size_) {
-            return &*storage.begin();
-        } else if (size_ > max_size_){
-            return impl::aligned_heap_addr(heap_storage,alignment);
+        if (storage.size_ > max_size_) {
+            return impl::aligned_heap_addr(storage.heap_storage,alignment);
         } else {
-            return nullptr;
+            return storage.inline_or_null();
         }
     }
 
+    const void* get() const noexcept
+    {
+        return const_cast<sso_storage_t&>(*this).get();
+    }
+
+    // precondition: n bytes are allocated, selects between the inline
+    // buffer and the heap block at compile time
+    template<size_t n>
+    void* get_sized() noexcept
+    {
+        return n <= max_size_ ? static_cast<void*>(storage.inline_addr()) :
+            impl::aligned_heap_addr(storage.heap_storage, alignment);
+    }
+
     template<size_t N>
     static constexpr bool is_alignment_ok(const impl::alignment_t<N>&)
     {
@@ -368,7 +849,7 @@ private:
             pointer p{};
             allocator_type temp_alloc = rhs.get_allocator();
             if (rhs.size() > rhs.max_size()) {
-                p = temp_alloc.allocate(rhs.size());
+                p = heap_allocation::allocate(temp_alloc, rhs.size(), alignment);
             }
             deallocate();
             get_allocator() = ::std::move(temp_alloc);
@@ -441,7 +922,7 @@ private:
         // provide strong exception guarantee
         pointer p{};
         if (rhs.size() > rhs.max_size()) {
-            p = get_allocator().allocate(rhs.size());
+            p = heap_allocation::allocate(get_allocator(), rhs.size(), alignment);
         }
         deallocate();
         assign_storage(p, rhs.size());
@@ -477,40 +958,58 @@ private:
     }
 
     void swap_guts(sso_storage_t& rhs) noexcept{
-        using std::swap;
-        swap(heap_storage,rhs.heap_storage);
-        swap(size_,rhs.size_);
+        storage.swap(rhs.storage);
     }
 
     // precondition: this storage is in deallocated state
     void* allocate_inline(size_t n) noexcept
     {
-        size_ = n;
-        return &*storage.begin();
+        storage.size_ = n;
+        return storage.inline_addr();
     }
 
     // precondition: this storage is in deallocated state
     void* allocate_with_allocator_aligned(size_t n)
     {
-        // allocating +alignment bytes to be able to
-        // align heap storage as well
-        allocate_with_allocator(n + alignment);
-        return impl::aligned_heap_addr(heap_storage,alignment);
+        // allocating +alignment bytes to be able to align heap storage
+        // unless the allocation strategy honors alignment natively
+        allocate_with_allocator(n + heap_allocation::overhead(alignment));
+        return impl::aligned_heap_addr(storage.heap_storage,alignment);
     }
 
     // precondition: this storage is in deallocated state
     void* allocate_with_allocator(size_t n)
     {
-        // allocating +alignment bytes to be able to
-        // align heap storage as well
-        heap_storage = get_allocator().allocate(n);
-        size_ = n;
-        return heap_storage;
+        auto r = heap_allocation::allocate_at_least(get_allocator(), n, alignment);
+        storage.heap_storage = r.ptr;
+        storage.size_ = r.count;
+        return storage.heap_storage;
+    }
+
+    // precondition: this storage is allocated
+    template<typename Relocate>
+    void reallocate_with_allocator(size_t n, Relocate& relocate)
+    {
+        const auto raw_size = ::std::max(n, max_size_ + 1) +
+            heap_allocation::overhead(alignment);
+        auto r = heap_allocation::allocate_at_least(get_allocator(), raw_size, alignment);
+        try {
+            relocate(impl::aligned_heap_addr(r.ptr, alignment), get());
+        }
+        catch (...) {
+            heap_allocation::deallocate(get_allocator(), r.ptr, r.count, alignment);
+            throw;
+        }
+        // the heap pointer may overlay the inline storage, so it can only
+        // be set after relocation
+        deallocate();
+        storage.heap_storage = r.ptr;
+        storage.size_ = r.count;
     }
 
     void allocation_check()
     {
-        if (size_ != 0) {
+        if (storage.size_ != 0) {
             throw ::std::bad_alloc {};
         }
     }
@@ -542,8 +1041,8 @@ private:
         }
         // use allocated storage else
         else if (size > 0) {
-            heap_storage = p;
-            size_ = size;
+            storage.heap_storage = p;
+            storage.size_ = size;
         }
     }
 
@@ -551,25 +1050,21 @@ private:
     // Data members
     ///////////////
 
-    ::std::array<::std::uint8_t,max_size_> storage alignas(alignment);
-    // storing in union was considered, but this results in cleaner
-    // and more correct swap logic
-    ::std::uint8_t* heap_storage;
-    size_t size_;
+    layout_type storage;
 };
 
 using sso_storage = sso_storage_t<>;
 
-template<size_t s, size_t a, class A>
-bool operator==(const sso_storage_t<s, a, A>& lhs,
-        const sso_storage_t<s, a, A>& rhs) noexcept
+template<size_t s, size_t a, class A, class L>
+bool operator==(const sso_storage_t<s, a, A, L>& lhs,
+        const sso_storage_t<s, a, A, L>& rhs) noexcept
 {
     return lhs.size() == rhs.size() && lhs.get_allocator() == lhs.get_allocator();
 }
 
-template<size_t s, size_t a, class A>
-bool operator!=(const sso_storage_t<s, a, A>& lhs,
-        const sso_storage_t<s, a, A>& rhs) noexcept
+template<size_t s, size_t a, class A, class L>
+bool operator!=(const sso_storage_t<s, a, A, L>& lhs,
+        const sso_storage_t<s, a, A, L>& rhs) noexcept
 {
     return !(lhs == rhs);
 }
@@ -579,17 +1074,19 @@ template<
     typename CloningPolicy = impl::DefaultCloningPolicy,
     size_t storage_size = 4,  // in pointer size
     size_t alignment = alignof(::std::max_align_t),
-    class Allocator = ::std::allocator<uint8_t>
+    class Allocator = ::std::allocator<uint8_t>,
+    class LayoutPolicy = SplitLayoutPolicy
 >
 class polymorphic_obj_storage_t {
 public:
-    using storage_t = sso_storage_t<storage_size, alignment,Allocator>;
+    using storage_t = sso_storage_t<storage_size, alignment,Allocator,LayoutPolicy>;
 
     using allocator_type = typename storage_t::allocator_type;
     using allocator_traits = ::std::allocator_traits<allocator_type>;
     using type = IF;
     static_assert(::std::is_polymorphic<type>::value, "IF class is not polymorphic");
     static_assert(::std::is_same<type, ::std::decay_t<type>>::value, "IF class must be cv unqualifed and non-reference type");
+    static_assert(alignof(type) > 1, "IF class pointer has no spare bit for tagging");
     //static_assert(noexcept(CloningPolicy::Move(::std::move(::std::declval<type>()), ::std::declval<void*>())),
     //    "IF type is not noexcept moveable");
 
@@ -598,13 +1095,9 @@ public:
         typename = ::std::enable_if_t<::std::is_base_of<type, ::std::decay_t<T>>::value>
     >
     explicit polymorphic_obj_storage_t(T&& t) :
-        storage { sizeof(::std::decay_t<T>) },
-        // using placement new for construction
-        obj { ::new (storage.get()) ::std::decay_t<T>(std::forward<T>(t)) }
+        polymorphic_obj_storage_t(in_place_type_t<::std::decay_t<T>> { },
+            ::std::forward<T>(t))
     {
-        static_assert( storage_t::is_alignment_ok(
-                        impl::alignment_t<alignof(::std::decay_t<T>)> {}),
-                "T is not properly aligned");
     }
 
     template<
@@ -613,13 +1106,34 @@ public:
         typename = ::std::enable_if_t<::std::is_base_of<type, ::std::decay_t<T>>::value>
     >
     explicit polymorphic_obj_storage_t(std::allocator_arg_t,A&& a, T&& t) :
-        storage { std::allocator_arg,std::forward<A>(a), sizeof(::std::decay_t<T>) },
-        // using placement new for construction
-        obj { ::new (storage.get()) ::std::decay_t<T>(std::forward<T>(t)) }
+        polymorphic_obj_storage_t(std::allocator_arg, std::forward<A>(a),
+            in_place_type_t<::std::decay_t<T>> { }, ::std::forward<T>(t))
+    {
+    }
+
+    // constructs T from args directly in the storage
+    template<
+        typename T,
+        typename ... Args,
+        typename = ::std::enable_if_t<::std::is_base_of<type, T>::value>
+    >
+    explicit polymorphic_obj_storage_t(in_place_type_t<T>, Args&&... args) :
+        storage { sizeof(T) },
+        obj { tag(construct<T>(::std::forward<Args>(args)...)) }
+    {
+    }
+
+    template<
+        typename A,
+        typename T,
+        typename ... Args,
+        typename = ::std::enable_if_t<::std::is_base_of<type, T>::value>
+    >
+    explicit polymorphic_obj_storage_t(std::allocator_arg_t, A&& a,
+        in_place_type_t<T>, Args&&... args) :
+        storage { std::allocator_arg,std::forward<A>(a), sizeof(T) },
+        obj { tag(construct<T>(::std::forward<Args>(args)...)) }
     {
-        static_assert( storage_t::is_alignment_ok(
-                        impl::alignment_t<alignof(::std::decay_t<T>)> {}),
-                "T is not properly aligned");
     }
 
     polymorphic_obj_storage_t() noexcept:
@@ -630,8 +1144,9 @@ public:
     polymorphic_obj_storage_t(const polymorphic_obj_storage_t& rhs) :
             storage { rhs.storage },
             obj { rhs.get() ?
-                    CloningPolicy::Clone(*rhs.get(), storage.get()) :
-                    nullptr }
+                    tag(CloningPolicy::Clone(*rhs.get(), storage.get()),
+                        rhs.trivially_relocatable()) :
+                    0 }
     {
     }
 
@@ -640,12 +1155,12 @@ public:
     {
         // successful storage swap, reset rhs obj pointer
         if (storage.size() > storage.max_size()) {
-            rhs.obj = nullptr;
+            rhs.obj = 0;
         }
         // need to move object if inline allocation happened
         // and rhs has an object
         else if (rhs) {
-            obj = CloningPolicy::Move(::std::move(*rhs.get()), storage.get());
+            move_object(rhs);
         }
     }
 
@@ -656,7 +1171,8 @@ public:
             cleanup();
             storage = rhs.storage;
             obj = rhs.get() ?
-                CloningPolicy::Clone(*rhs.get(), storage.get()) : nullptr;
+                tag(CloningPolicy::Clone(*rhs.get(), storage.get()),
+                    rhs.trivially_relocatable()) : 0;
         }
         return *this;
     }
@@ -672,8 +1188,7 @@ public:
             if (rhs.storage.size() > 0 &&
                 rhs.storage.size() <= rhs.storage.max_size()) {
                 storage = ::std::move(rhs.storage);
-                obj = CloningPolicy::Move(::std::move(*rhs.get()),
-                        storage.get());
+                move_object(rhs);
             } else if (rhs.storage.size() > 0) {
                 move_assign_w_allocated_obj(::std::move(rhs),
                     ::std::is_nothrow_move_assignable<storage_t>{});
@@ -689,26 +1204,46 @@ public:
         noexcept(noexcept(std::declval<storage_t&>().swap_object(std::declval<storage_t&>())))
     {
         using std::swap;
-        auto& old_obj = *get();
-        auto& old_rhs_obj = *rhs.get();
+        // the heap pointer would overwrite the inline allocated object
+        if (!LayoutPolicy::inline_stable_on_swap &&
+            (storage.size() <= storage.max_size()) !=
+            (rhs.storage.size() <= rhs.storage.max_size())) {
+            if (storage.size() <= storage.max_size()) {
+                swap_w_inline_relocated(*this, rhs);
+            } else {
+                swap_w_inline_relocated(rhs, *this);
+            }
+            return;
+        }
+        // inline buffers are stable, the old objects stay in place
+        auto old_obj = obj;
+        auto old_rhs_obj = rhs.obj;
+        auto old_addr = storage.get();
+        auto old_rhs_addr = rhs.storage.get();
         storage.swap_object(rhs.storage);
         // If both are inline allocated use 3 way move
         if (storage.size() <= storage.max_size() && 
             rhs.storage.size() <= rhs.storage.max_size()) {
-            storage_t temp(storage);
-            auto& tobj = *CloningPolicy::Move(::std::move(old_obj), temp.get());
-            obj = CloningPolicy::Move(::std::move(old_rhs_obj),get());
-            rhs.obj = CloningPolicy::Move(::std::move(tobj), rhs.storage.get());
-            tobj.~IF();
+            storage_t temp(rhs.storage);
+            auto tobj = relocate(old_obj, old_addr, temp.get(),
+                rhs.storage.size());
+            obj = relocate(old_rhs_obj, old_rhs_addr, storage.get(),
+                storage.size());
+            rhs.obj = relocate(tobj, temp.get(), rhs.storage.get(),
+                rhs.storage.size());
         }
         // If one was inline allocated move only the inline one
         else if (storage.size() <= storage.max_size() && 
             rhs.storage.size() > rhs.storage.max_size()) {
-            swap_w_inline_allocated(*this, std::move(old_rhs_obj),rhs,old_obj);
+            obj = relocate(old_rhs_obj, old_rhs_addr, storage.get(),
+                storage.size());
+            rhs.obj = old_obj;
         }
         else if (rhs.storage.size() <= rhs.storage.max_size() &&
             storage.size() > storage.max_size()) {
-            swap_w_inline_allocated(rhs, std::move(old_obj),*this,old_rhs_obj);
+            rhs.obj = relocate(old_obj, old_addr, rhs.storage.get(),
+                rhs.storage.size());
+            obj = old_rhs_obj;
         }
         // just swap objects
         else {
@@ -716,6 +1251,27 @@ public:
         }
     }
 
+    // Destroys the stored object and constructs T from args in place,
+    // the allocation is kept if T is placed the same way (inline or on the
+    // heap) and fits its usable capacity. Provides basic guarantee, the
+    // storage is left empty if the construction throws.
+    template<typename T, typename ... Args>
+    T& emplace(Args&&... args)
+    {
+        static_assert(::std::is_base_of<type, T>::value,
+            "T is not derived from IF class");
+        destroy();
+        if (!storage ||
+            (sizeof(T) <= storage.max_size()) != (storage.size() <= storage.max_size()) ||
+            !storage.try_expand_in_place(sizeof(T))) {
+            storage.deallocate();
+            storage.allocate(sizeof(T));
+        }
+        auto p = construct<T>(::std::forward<Args>(args)...);
+        obj = tag(p);
+        return *p;
+    }
+
     ~polymorphic_obj_storage_t()
     {
         destroy();
@@ -723,27 +1279,34 @@ public:
 
     type* get() noexcept
     {
-        return obj;
+        return untag(obj);
     }
 
     const type* get() const noexcept
     {
-        return obj;
+        return untag(obj);
     }
 
     operator bool()const noexcept
     {
-        return obj != nullptr;
+        return obj != 0;
     }
 
     type* operator->() noexcept
     {
-        return obj;
+        return get();
     }
 
     const type* operator->() const noexcept
     {
-        return obj;
+        return get();
+    }
+
+    // true if the stored object is relocated by a bytewise copy on moves
+    // and swaps, see is_trivially_relocatable
+    bool trivially_relocatable() const noexcept
+    {
+        return (obj & relocatable_tag) != 0;
     }
 
     allocator_type& get_allocator() noexcept
@@ -757,12 +1320,101 @@ public:
     }
 
 private:
-    static void swap_w_inline_allocated(polymorphic_obj_storage_t& dest, IF&& old_obj, 
-        polymorphic_obj_storage_t& src, IF& swapped_obj) noexcept
+    // the object pointer is stored with the trivially relocatable
+    // property of the object's dynamic type in its lowest bit
+    using tagged_ptr = uintptr_t;
+
+    static constexpr tagged_ptr relocatable_tag = 1;
+
+    static tagged_ptr tag(type* p, bool trivially_relocatable) noexcept
+    {
+        return reinterpret_cast<tagged_ptr>(p) |
+            (trivially_relocatable ? relocatable_tag : 0);
+    }
+
+    template<typename T>
+    static tagged_ptr tag(T* p) noexcept
+    {
+        return tag(p, is_trivially_relocatable<T>::value);
+    }
+
+    static type* untag(tagged_ptr p) noexcept
     {
-        dest.obj = CloningPolicy::Move(::std::move(old_obj), dest.storage.get());
-        old_obj.~IF();
-        src.obj = &swapped_obj;
+        return reinterpret_cast<type*>(p & ~relocatable_tag);
+    }
+
+    // precondition: storage is allocated with sizeof(T) bytes
+    template<typename T, typename ... Args>
+    T* construct(Args&&... args)
+    {
+        static_assert( storage_t::is_alignment_ok(
+                        impl::alignment_t<alignof(T)> {}),
+                "T is not properly aligned");
+        // using placement new for construction
+        return ::new (storage.get()) T(::std::forward<Args>(args)...);
+    }
+
+    // Moves the object o (if any) starting at src to dest and ends the
+    // lifetime of the source object. Trivially relocatable objects are copied bytewise,
+    // keeping the offset of the IF subobject, others are moved via the
+    // CloningPolicy and destroyed.
+    static tagged_ptr relocate(tagged_ptr o, void* src, void* dest,
+        size_t size) noexcept
+    {
+        if (!o) {
+            return 0;
+        }
+        if (o & relocatable_tag) {
+            ::std::memcpy(dest, src, size);
+            auto offset = reinterpret_cast<uint8_t*>(untag(o)) -
+                static_cast<uint8_t*>(src);
+            return tag(reinterpret_cast<type*>(
+                static_cast<uint8_t*>(dest) + offset), true);
+        }
+        auto moved = CloningPolicy::Move(::std::move(*untag(o)), dest);
+        untag(o)->~IF();
+        return tag(moved, false);
+    }
+
+    // precondition: storage is allocated with the size of rhs storage, rhs
+    // has an active object that can not be taken over
+    void move_object(polymorphic_obj_storage_t& rhs) noexcept
+    {
+        if (rhs.trivially_relocatable()) {
+            // heap sizes include the alignment overhead, the usable size of
+            // both blocks is large enough for the object
+            auto size = storage.size() <= storage.max_size() ? storage.size() :
+                ::std::min(storage.capacity(), rhs.storage.capacity());
+            obj = relocate(rhs.obj, rhs.storage.get(), storage.get(), size);
+            // the object lives in this storage now
+            rhs.obj = 0;
+        }
+        else {
+            obj = tag(CloningPolicy::Move(::std::move(*rhs.get()),
+                storage.get()), false);
+        }
+    }
+
+    // moves the inline allocated object to a temporary storage before
+    // swapping the storages, as required by layouts where the heap pointer
+    // overlays the inline buffer
+    static void swap_w_inline_relocated(polymorphic_obj_storage_t& inl,
+        polymorphic_obj_storage_t& allocated)
+    {
+        storage_t temp(inl.storage);
+        auto tobj = relocate(inl.obj, inl.storage.get(), temp.get(),
+            inl.storage.size());
+        try {
+            inl.storage.swap_object(allocated.storage);
+        }
+        catch (...) {
+            inl.obj = relocate(tobj, temp.get(), inl.storage.get(),
+                inl.storage.size());
+            throw;
+        }
+        inl.obj = allocated.obj;
+        allocated.obj = relocate(tobj, temp.get(), allocated.storage.get(),
+            allocated.storage.size());
     }
 
     // precondition: object has been cleaned up, rhs has an active,
@@ -790,17 +1442,16 @@ private:
         }
         // else move object to newly allocated storage
         else {
-            obj = CloningPolicy::Move(::std::move(*rhs.get()),
-                storage.get());
+            move_object(rhs);
         }
     }
 
     void destroy() noexcept
     {
         if (obj) {
-            obj->~IF();
+            get()->~IF();
         }
-        obj = nullptr;
+        obj = 0;
     }
 
     void cleanup() noexcept
@@ -813,25 +1464,25 @@ private:
     ///// member variables
     /////////////////////////
     storage_t storage;
-    type* obj;
+    tagged_ptr obj;
 };
 
 template<typename IF>
 using polymorphic_obj_storage = polymorphic_obj_storage_t<IF>;
 
 
-template<size_t s,size_t a, class A>
-inline void swap(sso_storage_t<s,a,A>& lhs ,sso_storage_t<s,a,A>& rhs)
-noexcept(noexcept(std::declval<::estd::sso_storage_t<s, a, A>&>()
-        .swap_object(std::declval<::estd::sso_storage_t<s, a, A>&>())))
+template<size_t s,size_t a, class A, class L>
+inline void swap(sso_storage_t<s,a,A,L>& lhs ,sso_storage_t<s,a,A,L>& rhs)
+noexcept(noexcept(std::declval<::estd::sso_storage_t<s, a, A, L>&>()
+        .swap_object(std::declval<::estd::sso_storage_t<s, a, A, L>&>())))
 {
     lhs.swap_object(rhs);
 }
 
-template<class I,class C,size_t s, size_t a, class A>
-inline void swap(polymorphic_obj_storage_t<I,C,s, a, A>& lhs, polymorphic_obj_storage_t<I,C,s, a, A>& rhs)
-noexcept(noexcept(std::declval<::estd::polymorphic_obj_storage_t<I, C, s, a, A>&>()
-    .swap_object(std::declval<::estd::polymorphic_obj_storage_t<I, C, s, a, A>&>())))
+template<class I,class C,size_t s, size_t a, class A, class L>
+inline void swap(polymorphic_obj_storage_t<I,C,s, a, A, L>& lhs, polymorphic_obj_storage_t<I,C,s, a, A, L>& rhs)
+noexcept(noexcept(std::declval<::estd::polymorphic_obj_storage_t<I, C, s, a, A, L>&>()
+    .swap_object(std::declval<::estd::polymorphic_obj_storage_t<I, C, s, a, A, L>&>())))
 {
     lhs.swap_object(rhs);
 }
@@ -868,15 +1519,96 @@ private:
 };
 
 struct poly_alloc_t {
+    // Allocators with equal identities can deallocate each other's memory.
+    // type is a token of the allocator type, instance distinguishes
+    // instances of that type, 0 if all of them are equal.
+    struct identity_t {
+        const void* type;
+        uintptr_t instance;
+    };
+
     virtual void* allocate(size_t n, const void* hint = nullptr) = 0;
     virtual void deallocate(void* p, size_t n) noexcept = 0;
     virtual size_t max_size() const noexcept = 0;
     virtual poly_alloc_t* clone(poly_alloc_t& a) const = 0;
-    virtual bool operator==(const poly_alloc_t&) const noexcept = 0;
+
+    // Allocates n bytes aligned to alignment (a power of 2). The default
+    // serves alignments above alignof(max_align_t) from an allocate() of
+    // n + alignment + sizeof(void*) bytes, storing the pointer it returned
+    // in front of the block. Named apart from allocate() so a literal 0
+    // hint stays unambiguous.
+    virtual void* allocate_aligned(size_t n, size_t alignment) {
+        if (alignment <= alignof(::std::max_align_t)) {
+            return allocate(n);
+        }
+        auto raw = static_cast<uint8_t*>(allocate(n + alignment + sizeof(void*)));
+        auto p = static_cast<uint8_t*>(impl::aligned_heap_addr(raw + sizeof(void*), alignment));
+        ::std::memcpy(p - sizeof(void*), &raw, sizeof(void*));
+        return p;
+    }
+
+    // precondition: n and alignment are the same as on allocation
+    virtual void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept {
+        if (alignment <= alignof(::std::max_align_t)) {
+            return deallocate(p, n);
+        }
+        uint8_t* raw;
+        ::std::memcpy(&raw, static_cast<uint8_t*>(p) - sizeof(void*), sizeof(void*));
+        deallocate(raw, n + alignment + sizeof(void*));
+    }
+
+    // Allocates count blocks of n bytes into out, either all of them or none.
+    // Resources that can serve a batch at once override it, the default
+    // allocates one by one.
+    virtual void allocate_bulk(size_t n, size_t count, void** out) {
+        size_t i = 0;
+        try {
+            for (; i < count; ++i) {
+                out[i] = allocate(n);
+            }
+        } catch (...) {
+            deallocate_bulk(out, i, n);
+            throw;
+        }
+    }
+
+    virtual void deallocate_bulk(void* const* p, size_t count, size_t n) noexcept {
+        for (size_t i = 0; i < count; ++i) {
+            deallocate(p[i], n);
+        }
+    }
+
+    bool operator==(const poly_alloc_t& rhs) const noexcept {
+        return identity.type == rhs.identity.type && identity.instance == rhs.identity.instance;
+    }
     bool operator!=(const poly_alloc_t& rhs) const noexcept {
         return !(*this == rhs);
     }
+    const identity_t& get_identity() const noexcept {
+        return identity;
+    }
     virtual ~poly_alloc_t() = default;
+
+protected:
+    // unique identity, copies compare equal
+    poly_alloc_t() noexcept : identity{ nullptr, new_instance_id() } {}
+    explicit poly_alloc_t(const identity_t& id) noexcept : identity{ id } {}
+    poly_alloc_t(const poly_alloc_t&) noexcept = default;
+    poly_alloc_t& operator=(const poly_alloc_t&) noexcept = default;
+
+    static uintptr_t new_instance_id() noexcept {
+        static std::atomic<uintptr_t> next{ 1 };
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template<class T>
+    static const void* type_token() noexcept {
+        static const char token{};
+        return &token;
+    }
+
+private:
+    identity_t identity;
 };
 
 
@@ -904,9 +1636,13 @@ public:
 
     static_assert(std::is_same<uint8_t, value_type>::value, "Alloc has to be a byte allocator");
 
-    poly_alloc_impl() {}
-    poly_alloc_impl(const Alloc& a) : Alloc(a) {}
-    poly_alloc_impl(Alloc&& a) : Alloc(std::move(a)) {}
+    poly_alloc_impl() : poly_alloc_t(make_identity()) {}
+    poly_alloc_impl(const Alloc& a) : poly_alloc_t(make_identity()), Alloc(a) {}
+    poly_alloc_impl(Alloc&& a) : poly_alloc_t(make_identity()), Alloc(std::move(a)) {}
+
+    // the comparisons of Alloc are hidden
+    using poly_alloc_t::operator==;
+    using poly_alloc_t::operator!=;
 
     void* allocate(size_t n, const void* hint = nullptr) override {
         return this->allocator_type::allocate(n,static_cast<const_pointer>(hint));
@@ -916,20 +1652,22 @@ public:
     {
         this->allocator_type::deallocate(static_cast<pointer>(p), n);
     }
+
+    // uses the aligned extension of Alloc if it has one, aligned new for
+    // std::allocator and the padded default otherwise
+    void* allocate_aligned(size_t n, size_t alignment) override {
+        return allocate_aligned_impl(n, alignment, typename impl::has_aligned_allocate<Alloc>::type{});
+    }
+
+    void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override {
+        deallocate_aligned_impl(p, n, alignment, typename impl::has_aligned_allocate<Alloc>::type{});
+    }
     
     size_t max_size() const noexcept override 
     {
         return this->allocator_type::max_size();
     }
     
-    bool operator==(const poly_alloc_t& rhs) const noexcept override {
-        // TODO(fecjanky) : this is slow, need to come up with something better
-        //auto other = dynamic_cast<const poly_alloc_impl*>(&rhs);
-        //return  other != nullptr && this->allocator() == other->allocator();
-        return true;
-        //return false;
-    }
-
     allocator_type& allocator() noexcept {
         return static_cast<allocator_type&>(*this);
     }
@@ -949,6 +1687,42 @@ public:
         return p.release();
     }
 
+private:
+    static constexpr bool is_std_allocator = std::is_same<Alloc, std::allocator<uint8_t>>::value;
+
+    void* allocate_aligned_impl(size_t n, size_t alignment, std::true_type) {
+        return this->allocator_type::allocate(n, alignment);
+    }
+
+    void* allocate_aligned_impl(size_t n, size_t alignment, std::false_type) {
+        if (alignment <= alignof(::std::max_align_t)) {
+            return allocate(n);
+        }
+        return is_std_allocator ? impl::aligned_new(n, alignment) : poly_alloc_t::allocate_aligned(n, alignment);
+    }
+
+    void deallocate_aligned_impl(void* p, size_t n, size_t alignment, std::true_type) noexcept {
+        this->allocator_type::deallocate(static_cast<pointer>(p), n, alignment);
+    }
+
+    void deallocate_aligned_impl(void* p, size_t n, size_t alignment, std::false_type) noexcept {
+        if (alignment <= alignof(::std::max_align_t)) {
+            return deallocate(p, n);
+        }
+        if (is_std_allocator) {
+            impl::aligned_delete(p, alignment);
+        } else {
+            poly_alloc_t::deallocate_aligned(p, n, alignment);
+        }
+    }
+
+    // instances of always equal allocators share their identity, the others
+    // only with their copies
+    static identity_t make_identity() noexcept {
+        return identity_t{ type_token<poly_alloc_impl>(),
+            impl::allocator_is_always_equal_t<Alloc>::value ? 0 : new_instance_id() };
+    }
+
 };
 
 template<typename T>
@@ -980,12 +1754,26 @@ public:
         return *this;
     }
 
+    // over-aligned T is allocated through the aligned interface
     pointer allocate(size_t n) {
-        return static_cast<pointer>(_a->allocate(n * sizeof(T)));
+        return is_over_aligned ?
+            allocate(n, alignof(T)) : static_cast<pointer>(_a->allocate(n * sizeof(T)));
     }
     
     void deallocate(pointer p, size_t n) noexcept {
-        _a->deallocate(p, n * sizeof(T));
+        if (is_over_aligned) {
+            deallocate(p, n, alignof(T));
+        } else {
+            _a->deallocate(p, n * sizeof(T));
+        }
+    }
+
+    pointer allocate(size_t n, size_t alignment) {
+        return static_cast<pointer>(_a->allocate_aligned(n * sizeof(T), alignment));
+    }
+
+    void deallocate(pointer p, size_t n, size_t alignment) noexcept {
+        _a->deallocate_aligned(p, n * sizeof(T), alignment);
     }
 
     poly_alloc_t& allocator() const noexcept {
@@ -1008,15 +1796,62 @@ public:
     }
 
 private:
+    static constexpr bool is_over_aligned = alignof(T) > alignof(::std::max_align_t);
+
     poly_alloc_t* _a;
 };
     
+class scoped_default_allocator;
+
 class default_poly_allocator {
 public:
-    static poly_alloc_t& instance() {
+    // the default of the calling thread, installed by the innermost
+    // scoped_default_allocator, the process wide one otherwise
+    static poly_alloc_t& instance() noexcept {
+        auto a = current();
+        return a ? *a : global();
+    }
+
+    static poly_alloc_t& global() noexcept {
         static poly_alloc_impl<std::allocator<uint8_t>> a;
         return a;
     }
+
+private:
+    friend class scoped_default_allocator;
+
+    // constant initialized, reading it needs no guard
+    static poly_alloc_t*& current() noexcept {
+        static thread_local poly_alloc_t* a = nullptr;
+        return a;
+    }
+};
+
+// Installs a as the default poly allocator of the calling thread for its
+// lifetime, e.g. the arena of a request for default constructed
+// poly_alloc_wrapper instances deep in library code. Such wrappers keep
+// referring to a, they must not outlive it. The resources default their
+// upstream to default_poly_allocator::global() instead, so long lived
+// pools created within a scope don't capture a. Scopes nest, the
+// previous default is restored on destruction.
+// precondition: destroyed on the creating thread, in reverse order of creation
+class scoped_default_allocator {
+public:
+    explicit scoped_default_allocator(poly_alloc_t& a) noexcept :
+        previous{ default_poly_allocator::current() }
+    {
+        default_poly_allocator::current() = &a;
+    }
+
+    scoped_default_allocator(const scoped_default_allocator&) = delete;
+    scoped_default_allocator& operator=(const scoped_default_allocator&) = delete;
+
+    ~scoped_default_allocator() {
+        default_poly_allocator::current() = previous;
+    }
+
+private:
+    poly_alloc_t* previous;
 };
 
 template<typename T>
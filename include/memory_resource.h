@@ -0,0 +1,2992 @@
+// Copyright (c) 2016 Ferenc Nandor Janky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef MEMORY_RESOURCE_H_
+#define MEMORY_RESOURCE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "memory.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace estd {
+
+namespace impl {
+
+inline uintptr_t align_up(uintptr_t p, size_t alignment) noexcept
+{
+    return (p + alignment - 1) & ~(uintptr_t { alignment } - 1);
+}
+
+// poly_alloc_t referring to a resource owned elsewhere, this is what
+// cloning a resource yields
+template<class Resource>
+class poly_resource_ref : public poly_alloc_t {
+public:
+    explicit poly_resource_ref(Resource& r) noexcept :
+        poly_alloc_t { r.get_identity() }, r { &r }
+    {
+    }
+
+    void* allocate(size_t n, const void* hint = nullptr) override
+    {
+        return r->allocate(n, hint);
+    }
+
+    void deallocate(void* p, size_t n) noexcept override
+    {
+        r->deallocate(p, n);
+    }
+
+    void* allocate_aligned(size_t n, size_t alignment) override
+    {
+        return r->allocate_aligned(n, alignment);
+    }
+
+    void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override
+    {
+        r->deallocate_aligned(p, n, alignment);
+    }
+
+    void allocate_bulk(size_t n, size_t count, void** out) override
+    {
+        r->allocate_bulk(n, count, out);
+    }
+
+    void deallocate_bulk(void* const* p, size_t count, size_t n) noexcept override
+    {
+        r->deallocate_bulk(p, count, n);
+    }
+
+    size_t max_size() const noexcept override
+    {
+        return r->max_size();
+    }
+
+    poly_alloc_t* clone(poly_alloc_t& a) const override
+    {
+        return clone_resource_ref(*r, a);
+    }
+
+    template<class R>
+    static poly_alloc_t* clone_resource_ref(R& r, poly_alloc_t& a)
+    {
+        auto p = a.allocate(sizeof(poly_resource_ref));
+        return ::new (p) poly_resource_ref(r);
+    }
+
+private:
+    Resource* r;
+};
+
+constexpr size_t log2(size_t n) noexcept
+{
+    return n > 1 ? 1 + log2(n / 2) : 0;
+}
+
+// index of the highest set bit, precondition: x != 0
+inline size_t highest_bit(uint64_t x) noexcept
+{
+#if defined(__GNUC__)
+    return 63 - static_cast<size_t>(__builtin_clzll(x));
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long i;
+    _BitScanReverse64(&i, x);
+    return i;
+#else
+    size_t i = 0;
+    while (x >>= 1) {
+        ++i;
+    }
+    return i;
+#endif
+}
+
+// index of the lowest set bit, precondition: x != 0
+inline size_t lowest_bit(uint64_t x) noexcept
+{
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_ctzll(x));
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return i;
+#else
+    size_t i = 0;
+    for (; !(x & 1); x >>= 1) {
+        ++i;
+    }
+    return i;
+#endif
+}
+
+// Size classes of the pools are multiples of alignof(max_align_t)
+constexpr size_t size_class_granularity = alignof(::std::max_align_t);
+
+inline size_t size_class_count(size_t max_size) noexcept
+{
+    return (max_size + size_class_granularity - 1) / size_class_granularity;
+}
+
+inline size_t size_class_index(size_t n) noexcept
+{
+    return n == 0 ? 0 : (n - 1) / size_class_granularity;
+}
+
+inline size_t size_class_size(size_t index) noexcept
+{
+    return (index + 1) * size_class_granularity;
+}
+
+// intrusive free list node stored in unused pool blocks
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+// Pushes count blocks of n bytes allocated in bulk from a onto the free
+// list, filled is incremented as they are added
+inline void fill_free_list(poly_alloc_t& a, size_t n, size_t count,
+    FreeBlock*& head, size_t& filled)
+{
+    constexpr size_t batch = 32;
+    void* blocks[batch];
+    while (count) {
+        auto k = ::std::min(count, batch);
+        a.allocate_bulk(n, k, blocks);
+        for (size_t i = 0; i < k; ++i) {
+            auto b = static_cast<FreeBlock*>(blocks[i]);
+            b->next = head;
+            head = b;
+        }
+        filled += k;
+        count -= k;
+    }
+}
+
+// Returns up to count blocks of n bytes of the free list to a in bulk,
+// yields the number of blocks returned
+inline size_t drain_free_list(poly_alloc_t& a, size_t n, size_t count,
+    FreeBlock*& head) noexcept
+{
+    constexpr size_t batch = 32;
+    void* blocks[batch];
+    size_t drained = 0;
+    while (head && drained < count) {
+        size_t k = 0;
+        for (; head && k < batch && drained + k < count; ++k) {
+            blocks[k] = head;
+            head = head->next;
+        }
+        a.deallocate_bulk(blocks, k, n);
+        drained += k;
+    }
+    return drained;
+}
+
+// Bulk allocation by allocate(n, alignment) of a resource without virtual
+// dispatch, for resources serving a batch one by one
+template<class Resource>
+void allocate_each(Resource& r, size_t n, size_t count, void** out)
+{
+    size_t i = 0;
+    try {
+        for (; i < count; ++i) {
+            out[i] = r.Resource::allocate(n, alignof(::std::max_align_t));
+        }
+    } catch (...) {
+        while (i-- > 0) {
+            r.Resource::deallocate(out[i], n, alignof(::std::max_align_t));
+        }
+        throw;
+    }
+}
+
+template<class Resource>
+void deallocate_each(Resource& r, void* const* p, size_t count, size_t n) noexcept
+{
+    for (size_t i = 0; i < count; ++i) {
+        r.Resource::deallocate(p[i], n, alignof(::std::max_align_t));
+    }
+}
+
+// Objects (e.g. caches) of Owner bound to the calling thread. Destroyed at
+// thread exit, it hands the still bound ones back by owner->unbind(binding),
+// an Owner outliving its bindings releases them. Whoever clears the owner of
+// a binding first tears it down, the Owner waits for a pending unbind.
+template<class Owner, class T>
+class ThreadBindings {
+public:
+    struct binding_t {
+        ::std::atomic<Owner*> owner;
+        T* value;
+    };
+
+    // Releases the bindings of values (having a bound member) of an Owner
+    // being destroyed, the bindings are not touched afterwards.
+    template<class Values>
+    static void release_all(::std::mutex& mutex, Values& values) noexcept
+    {
+        for (;;) {
+            bool pending = false;
+            {
+                ::std::lock_guard<::std::mutex> lock { mutex };
+                for (auto& v : values) {
+                    if (!v->bound) {
+                        continue;
+                    }
+                    if (v->bound->owner.exchange(nullptr, ::std::memory_order_acq_rel)) {
+                        v->bound = nullptr;
+                    } else {
+                        // the thread exits, its unbind clears bound
+                        pending = true;
+                    }
+                }
+            }
+            if (!pending) {
+                return;
+            }
+            ::std::this_thread::yield();
+        }
+    }
+
+    static ThreadBindings& local() noexcept
+    {
+        thread_local ThreadBindings bindings;
+        return bindings;
+    }
+
+    ~ThreadBindings()
+    {
+        for (auto& b : bindings) {
+            auto owner = b->owner.exchange(nullptr, ::std::memory_order_acq_rel);
+            if (owner) {
+                owner->unbind(*b);
+            }
+        }
+    }
+
+    binding_t* find(const Owner* owner) noexcept
+    {
+        if (last && last->owner.load(::std::memory_order_relaxed) == owner) {
+            return last;
+        }
+        for (auto& b : bindings) {
+            if (b->owner.load(::std::memory_order_relaxed) == owner) {
+                return last = b.get();
+            }
+        }
+        return nullptr;
+    }
+
+    binding_t& add(Owner& owner, T* value)
+    {
+        // drop the bindings of destroyed owners
+        bindings.erase(::std::remove_if(bindings.begin(), bindings.end(),
+            [](const ::std::unique_ptr<binding_t>& b) {
+                return !b->owner.load(::std::memory_order_acquire);
+            }),
+            bindings.end());
+        last = nullptr;
+        ::std::unique_ptr<binding_t> b { new binding_t { { &owner }, value } };
+        bindings.push_back(::std::move(b));
+        return *(last = bindings.back().get());
+    }
+
+private:
+    ::std::vector<::std::unique_ptr<binding_t>> bindings;
+    binding_t* last = nullptr;
+};
+
+}  // namespace impl
+
+// Standard allocator over a memory resource (e.g. monotonic_arena_t),
+// instances referring to the same resource compare equal. The aligned
+// allocate(n, alignment) extension lets sso_storage_t skip padding.
+template<typename T, class Resource>
+class resource_allocator {
+public:
+    using value_type = T;
+    using resource_type = Resource;
+    using propagate_on_container_copy_assignment = ::std::true_type;
+    using propagate_on_container_move_assignment = ::std::true_type;
+    using propagate_on_container_swap = ::std::true_type;
+    using is_always_equal = ::std::false_type;
+
+    template<typename TT>
+    struct rebind {
+        using other = resource_allocator<TT, Resource>;
+    };
+
+    resource_allocator(Resource& r) noexcept : r { &r }
+    {
+    }
+
+    template<typename TT>
+    resource_allocator(const resource_allocator<TT, Resource>& a) noexcept :
+        r { &a.resource() }
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(r->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept
+    {
+        r->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    T* allocate(size_t n, size_t alignment)
+    {
+        return static_cast<T*>(r->allocate(n * sizeof(T), alignment));
+    }
+
+    void deallocate(T* p, size_t n, size_t alignment) noexcept
+    {
+        r->deallocate(p, n * sizeof(T), alignment);
+    }
+
+    size_t max_size() const noexcept
+    {
+        return r->max_size() / sizeof(T);
+    }
+
+    Resource& resource() const noexcept
+    {
+        return *r;
+    }
+
+    template<typename TT>
+    bool operator==(const resource_allocator<TT, Resource>& rhs) const noexcept
+    {
+        return r == &rhs.resource();
+    }
+
+    template<typename TT>
+    bool operator!=(const resource_allocator<TT, Resource>& rhs) const noexcept
+    {
+        return !(*this == rhs);
+    }
+
+private:
+    Resource* r;
+};
+
+// Bump pointer arena: allocations are carved from the initial
+// memory_resource_t block and from blocks obtained from the upstream
+// allocator, each one growing geometrically. Deallocation is a no-op,
+// release() returns the upstream blocks and rewinds the initial block.
+class monotonic_arena_t : public poly_alloc_t {
+public:
+    static constexpr size_t default_block_size = 4096;
+
+    template<typename T>
+    using allocator = resource_allocator<T, monotonic_arena_t>;
+
+    // obtains all memory from upstream
+    explicit monotonic_arena_t(
+        poly_alloc_t& upstream = default_poly_allocator::global(),
+        size_t block_size = default_block_size) noexcept :
+        initial { }, upstream { &upstream }, blocks { }, spare { }, next_block_size { block_size },
+        initial_block_size { block_size }, current { }, end { }
+    {
+    }
+
+    // allocates from the initial block only, throws bad_alloc when it
+    // is exhausted
+    explicit monotonic_arena_t(memory_resource_t initial) noexcept :
+        initial { initial }, upstream { }, blocks { }, spare { },
+        next_block_size { initial.size() }, initial_block_size { initial.size() },
+        current { static_cast<uint8_t*>(initial.ptr()) },
+        end { current + initial.size() }
+    {
+    }
+
+    // uses the initial block first, then obtains memory from upstream
+    monotonic_arena_t(memory_resource_t initial, poly_alloc_t& upstream,
+        size_t block_size = default_block_size) noexcept :
+        initial { initial }, upstream { &upstream }, blocks { }, spare { },
+        next_block_size { block_size }, initial_block_size { block_size },
+        current { static_cast<uint8_t*>(initial.ptr()) },
+        end { current + initial.size() }
+    {
+    }
+
+    monotonic_arena_t(const monotonic_arena_t&) = delete;
+    monotonic_arena_t& operator=(const monotonic_arena_t&) = delete;
+
+    ~monotonic_arena_t()
+    {
+        release();
+    }
+
+    // precondition: alignment is a power of 2
+    void* allocate(size_t n, size_t alignment)
+    {
+        // distinct non-null pointers for zero sized requests
+        n += n == 0;
+        auto p = reinterpret_cast<uint8_t*>(
+            impl::align_up(reinterpret_cast<uintptr_t>(current), alignment));
+        if (p >= current && p <= end && n <= static_cast<size_t>(end - p)) {
+            current = p + n;
+            return p;
+        }
+        return allocate_from_new_block(n, alignment);
+    }
+
+    void deallocate(void*, size_t, size_t) noexcept
+    {
+    }
+
+    void* allocate(size_t n, const void* = nullptr) override
+    {
+        return allocate(n, alignof(::std::max_align_t));
+    }
+
+    void deallocate(void*, size_t) noexcept override
+    {
+    }
+
+    void* allocate_aligned(size_t n, size_t alignment) override
+    {
+        return allocate(n, alignment);
+    }
+
+    void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override
+    {
+        deallocate(p, n, alignment);
+    }
+
+    // a single bump allocation split into count blocks
+    void allocate_bulk(size_t n, size_t count, void** out) override
+    {
+        if (!count) {
+            return;
+        }
+        auto size = impl::align_up(n + (n == 0), alignof(::std::max_align_t));
+        if (size > ::std::numeric_limits<size_t>::max() / count) {
+            throw ::std::bad_alloc { };
+        }
+        auto p = static_cast<uint8_t*>(allocate(size * count, alignof(::std::max_align_t)));
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = p + i * size;
+        }
+    }
+
+    void deallocate_bulk(void* const*, size_t, size_t) noexcept override
+    {
+    }
+
+    size_t max_size() const noexcept override
+    {
+        return upstream ? upstream->max_size() : initial.size();
+    }
+
+    poly_alloc_t* clone(poly_alloc_t& a) const override
+    {
+        return impl::poly_resource_ref<monotonic_arena_t>::clone_resource_ref(
+            const_cast<monotonic_arena_t&>(*this), a);
+    }
+
+    // allocation state of the arena, see checkpoint() and rollback()
+    struct checkpoint_t {
+        void* blocks;
+        uint8_t* current;
+        uint8_t* end;
+        size_t next_block_size;
+    };
+
+    checkpoint_t checkpoint() const noexcept
+    {
+        return checkpoint_t { blocks, current, end, next_block_size };
+    }
+
+    // Frees every allocation made since c was taken. Checkpoints have to be
+    // rolled back in LIFO order. The last block freed is kept as a spare,
+    // so repeatedly entering a scope does not go to upstream each time.
+    void rollback(const checkpoint_t& c) noexcept
+    {
+        while (blocks != c.blocks) {
+            auto prev = blocks->prev;
+            retire(blocks);
+            blocks = prev;
+        }
+        current = c.current;
+        end = c.end;
+        next_block_size = c.next_block_size;
+    }
+
+    // frees every allocation at once, returns the upstream blocks
+    void release() noexcept
+    {
+        rollback(checkpoint_t { nullptr, static_cast<uint8_t*>(initial.ptr()),
+            static_cast<uint8_t*>(initial.ptr()) + initial.size(),
+            initial_block_size });
+        if (spare) {
+            upstream->deallocate(spare, spare->size);
+            spare = nullptr;
+        }
+    }
+
+    template<typename T = uint8_t>
+    allocator<T> get_allocator() noexcept
+    {
+        return allocator<T>(*this);
+    }
+
+    // bytes left in the current block
+    size_t remaining() const noexcept
+    {
+        return static_cast<size_t>(end - current);
+    }
+
+private:
+    struct block_header {
+        block_header* prev;
+        size_t size;
+    };
+
+    void* allocate_from_new_block(size_t n, size_t alignment)
+    {
+        if (!upstream) {
+            throw ::std::bad_alloc {};
+        }
+        // the block size would wrap around
+        const auto limit = max_size();
+        if (limit < sizeof(block_header) + alignment ||
+            n > limit - sizeof(block_header) - alignment) {
+            throw ::std::bad_alloc {};
+        }
+        auto needed = sizeof(block_header) + alignment + n;
+        auto size = ::std::max(next_block_size, needed);
+        block_header* block;
+        if (spare && spare->size >= needed) {
+            block = spare;
+            size = spare->size;
+            spare = nullptr;
+        } else {
+            block = static_cast<block_header*>(upstream->allocate(size));
+        }
+        block->prev = blocks;
+        block->size = size;
+        blocks = block;
+        next_block_size = size * 2;
+        current = reinterpret_cast<uint8_t*>(block + 1);
+        end = reinterpret_cast<uint8_t*>(block) + size;
+        return allocate(n, alignment);
+    }
+
+    // keeps the larger of block and the spare block
+    void retire(block_header* block) noexcept
+    {
+        if (spare && spare->size < block->size) {
+            ::std::swap(spare, block);
+        }
+        if (!spare) {
+            spare = block;
+        } else {
+            upstream->deallocate(block, block->size);
+        }
+    }
+
+    //////////////////////////
+    ///// member variables
+    /////////////////////////
+    memory_resource_t initial;
+    poly_alloc_t* upstream;
+    block_header* blocks;
+    block_header* spare;
+    size_t next_block_size;
+    size_t initial_block_size;
+    uint8_t* current;
+    uint8_t* end;
+};
+
+// RAII checkpoint of a monotonic_arena_t: everything allocated from the
+// arena during the lifetime of the scope is freed when it ends, objects
+// allocated there must be destroyed before. The scope is a poly_alloc_t
+// allocating from the arena, e.g. to bind interface_t objects with
+// std::allocator_arg and poly_alloc_wrapper to the scope.
+class arena_scope : public poly_alloc_t {
+public:
+    template<typename T>
+    using allocator = resource_allocator<T, arena_scope>;
+
+    explicit arena_scope(monotonic_arena_t& arena) noexcept :
+        arena { &arena }, mark { arena.checkpoint() }
+    {
+    }
+
+    arena_scope(const arena_scope&) = delete;
+    arena_scope& operator=(const arena_scope&) = delete;
+
+    ~arena_scope()
+    {
+        arena->rollback(mark);
+    }
+
+    void* allocate(size_t n, size_t alignment)
+    {
+        return arena->allocate(n, alignment);
+    }
+
+    void deallocate(void*, size_t, size_t) noexcept
+    {
+    }
+
+    void* allocate(size_t n, const void* = nullptr) override
+    {
+        return arena->allocate(n, alignof(::std::max_align_t));
+    }
+
+    void deallocate(void*, size_t) noexcept override
+    {
+    }
+
+    void* allocate_aligned(size_t n, size_t alignment) override
+    {
+        return allocate(n, alignment);
+    }
+
+    void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override
+    {
+        deallocate(p, n, alignment);
+    }
+
+    void allocate_bulk(size_t n, size_t count, void** out) override
+    {
+        arena->allocate_bulk(n, count, out);
+    }
+
+    void deallocate_bulk(void* const*, size_t, size_t) noexcept override
+    {
+    }
+
+    size_t max_size() const noexcept override
+    {
+        return arena->max_size();
+    }
+
+    poly_alloc_t* clone(poly_alloc_t& a) const override
+    {
+        return impl::poly_resource_ref<arena_scope>::clone_resource_ref(
+            const_cast<arena_scope&>(*this), a);
+    }
+
+    template<typename T = uint8_t>
+    allocator<T> get_allocator() noexcept
+    {
+        return allocator<T>(*this);
+    }
+
+    // rolls back to the start of the scope before it ends
+    void reset() noexcept
+    {
+        arena->rollback(mark);
+    }
+
+    monotonic_arena_t& get_arena() const noexcept
+    {
+        return *arena;
+    }
+
+private:
+    monotonic_arena_t* arena;
+    monotonic_arena_t::checkpoint_t mark;
+};
+
+namespace impl {
+
+// the buffer has to be initialized before the arena using it
+template<size_t N, size_t alignment>
+struct InlineBuffer {
+    alignas(alignment) uint8_t buffer[N];
+};
+
+}  // namespace impl
+
+// monotonic_arena_t with its initial block of N bytes inside the object,
+// meant to live on the stack for short lived containers. Allocations
+// exceeding the inline block are served from upstream blocks.
+// get_allocator<T>() yields a resource_allocator (e.g. the byte Allocator
+// of sso_storage_t), get_poly_allocator<T>() a poly_alloc_wrapper.
+template<size_t N, size_t alignment = alignof(::std::max_align_t)>
+class inline_arena : private impl::InlineBuffer<N, alignment>, public monotonic_arena_t {
+    static_assert(N > 0, "inline_arena needs a non-empty buffer");
+
+public:
+    static constexpr size_t inline_size = N;
+
+    explicit inline_arena(
+        poly_alloc_t& upstream = default_poly_allocator::global(),
+        size_t block_size = default_block_size) :
+        monotonic_arena_t { memory_resource_t { this->buffer, N }, upstream, block_size }
+    {
+    }
+
+    template<typename T = uint8_t>
+    poly_alloc_wrapper<T> get_poly_allocator() noexcept
+    {
+        return poly_alloc_wrapper<T>(*this);
+    }
+
+    // the address is inside the inline block
+    bool is_inline(const void* p) const noexcept
+    {
+        auto a = reinterpret_cast<uintptr_t>(p);
+        auto b = reinterpret_cast<uintptr_t>(this->buffer);
+        return a >= b && a < b + N;
+    }
+};
+
+template<size_t N, size_t alignment>
+constexpr size_t inline_arena<N, alignment>::inline_size;
+
+// Pool of fixed size blocks in size classes of alignof(max_align_t)
+// granularity up to max_pooled_size. Each class has its own free list,
+// blocks are carved from slabs taken from a monotonic_arena_t over the
+// initial memory_resource_t and the upstream allocator, without per-block
+// headers. Larger requests are forwarded to upstream. Allocation and
+// deallocation of pooled sizes are O(1). Meant as the byte Allocator of
+// sso_storage_t heap spills, where only a few distinct sizes occur.
+class slab_pool_t : public poly_alloc_t {
+public:
+    static constexpr size_t granularity = impl::size_class_granularity;
+    static constexpr size_t default_max_pooled_size = 256;
+    static constexpr size_t default_slab_size = 4096;
+
+    template<typename T>
+    using allocator = resource_allocator<T, slab_pool_t>;
+
+    explicit slab_pool_t(
+        poly_alloc_t& upstream = default_poly_allocator::global(),
+        size_t max_pooled_size = default_max_pooled_size,
+        size_t slab_size = default_slab_size) :
+        slabs { upstream, slab_size * slabs_per_block }, upstream { &upstream },
+        classes(impl::size_class_count(max_pooled_size)), slab_size { slab_size }
+    {
+    }
+
+    slab_pool_t(memory_resource_t initial, poly_alloc_t& upstream,
+        size_t max_pooled_size = default_max_pooled_size,
+        size_t slab_size = default_slab_size) :
+        slabs { initial, upstream, slab_size * slabs_per_block }, upstream { &upstream },
+        classes(impl::size_class_count(max_pooled_size)), slab_size { slab_size }
+    {
+    }
+
+    slab_pool_t(const slab_pool_t&) = delete;
+    slab_pool_t& operator=(const slab_pool_t&) = delete;
+
+    void* allocate(size_t n, size_t alignment)
+    {
+        if (alignment > granularity) {
+            return upstream->allocate_aligned(n, alignment);
+        }
+        auto index = impl::size_class_index(n);
+        if (index >= classes.size()) {
+            return upstream->allocate(n);
+        }
+        auto& c = classes[index];
+        if (c.free) {
+            auto b = c.free;
+            c.free = b->next;
+            return b;
+        }
+        if (c.current == c.end) {
+            refill(c, impl::size_class_size(index));
+        }
+        auto p = c.current;
+        c.current += impl::size_class_size(index);
+        return p;
+    }
+
+    // precondition: n and alignment are the same as on allocation
+    void deallocate(void* p, size_t n, size_t alignment) noexcept
+    {
+        if (alignment > granularity) {
+            return upstream->deallocate_aligned(p, n, alignment);
+        }
+        auto index = impl::size_class_index(n);
+        if (index >= classes.size()) {
+            return upstream->deallocate(p, n);
+        }
+        auto& c = classes[index];
+        auto b = static_cast<free_block*>(p);
+        b->next = c.free;
+        c.free = b;
+    }
+
+    void* allocate(size_t n, const void* = nullptr) override
+    {
+        return allocate(n, granularity);
+    }
+
+    void deallocate(void* p, size_t n) noexcept override
+    {
+        deallocate(p, n, granularity);
+    }
+
+    void* allocate_aligned(size_t n, size_t alignment) override
+    {
+        return allocate(n, alignment);
+    }
+
+    void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override
+    {
+        deallocate(p, n, alignment);
+    }
+
+    void allocate_bulk(size_t n, size_t count, void** out) override
+    {
+        impl::allocate_each(*this, n, count, out);
+    }
+
+    void deallocate_bulk(void* const* p, size_t count, size_t n) noexcept override
+    {
+        impl::deallocate_each(*this, p, count, n);
+    }
+
+    size_t max_size() const noexcept override
+    {
+        return upstream->max_size();
+    }
+
+    poly_alloc_t* clone(poly_alloc_t& a) const override
+    {
+        return impl::poly_resource_ref<slab_pool_t>::clone_resource_ref(
+            const_cast<slab_pool_t&>(*this), a);
+    }
+
+    template<typename T = uint8_t>
+    allocator<T> get_allocator() noexcept
+    {
+        return allocator<T>(*this);
+    }
+
+    // Frees all pooled blocks at once. Blocks of sizes forwarded to
+    // upstream are not tracked and have to be deallocated before.
+    void release() noexcept
+    {
+        slabs.release();
+        for (auto& c : classes) {
+            c = size_class { };
+        }
+    }
+
+    // largest size served from the pool
+    size_t max_pooled_size() const noexcept
+    {
+        return classes.size() * granularity;
+    }
+
+private:
+    // slabs of several size classes share one upstream block
+    static constexpr size_t slabs_per_block = 4;
+
+    using free_block = impl::FreeBlock;
+
+    struct size_class {
+        free_block* free;
+        uint8_t* current;
+        uint8_t* end;
+    };
+
+    void refill(size_class& c, size_t size)
+    {
+        auto count = ::std::max(slab_size / size, size_t { 1 });
+        c.current = static_cast<uint8_t*>(slabs.allocate(count * size, granularity));
+        c.end = c.current + count * size;
+    }
+
+    //////////////////////////
+    ///// member variables
+    /////////////////////////
+    monotonic_arena_t slabs;
+    poly_alloc_t* upstream;
+    ::std::vector<size_class> classes;
+    size_t slab_size;
+};
+
+constexpr size_t slab_pool_t::granularity;
+constexpr size_t slab_pool_t::slabs_per_block;
+
+// Tuning of unsynchronized_pool and synchronized_pool, 0 selects the default
+struct pool_options_t {
+    // upper limit of the geometrically growing chunks of a pool
+    size_t max_blocks_per_chunk = 0;
+    // larger requests are passed to upstream
+    size_t largest_required_pool_block = 0;
+};
+
+// Pools of power of 2 sized blocks up to largest_required_pool_block, each
+// pool carves its blocks from chunks obtained from the upstream poly_alloc_t.
+// Larger and over-aligned requests are passed through to upstream and
+// tracked, so release() and the destructor return everything to upstream.
+// Not synchronized, see synchronized_pool.
+class unsynchronized_pool : public poly_alloc_t {
+public:
+    static constexpr size_t granularity = impl::size_class_granularity;
+    static constexpr size_t default_max_blocks_per_chunk = 1024;
+    static constexpr size_t default_largest_required_pool_block = 4096;
+
+    template<typename T>
+    using allocator = resource_allocator<T, unsynchronized_pool>;
+
+    explicit unsynchronized_pool(
+        poly_alloc_t& upstream = default_poly_allocator::global(),
+        pool_options_t options = { }) :
+        upstream { &upstream }, opts { normalize(options) },
+        pools(pool_index(opts.largest_required_pool_block) + 1)
+    {
+    }
+
+    unsynchronized_pool(const unsynchronized_pool&) = delete;
+    unsynchronized_pool& operator=(const unsynchronized_pool&) = delete;
+
+    ~unsynchronized_pool()
+    {
+        release();
+    }
+
+    void* allocate(size_t n, size_t alignment)
+    {
+        if (alignment > granularity || n > opts.largest_required_pool_block) {
+            return allocate_large(n, alignment);
+        }
+        auto index = pool_index(n);
+        auto& pool = pools[index];
+        if (pool.free) {
+            auto b = pool.free;
+            pool.free = b->next;
+            return b;
+        }
+        auto size = pool_block_size(index);
+        if (pool.current == pool.end) {
+            new_chunk(pool, size);
+        }
+        auto p = pool.current;
+        pool.current += size;
+        return p;
+    }
+
+    // precondition: n and alignment are the same as on allocation
+    void deallocate(void* p, size_t n, size_t alignment) noexcept
+    {
+        if (alignment > granularity || n > opts.largest_required_pool_block) {
+            return deallocate_large(p);
+        }
+        auto& pool = pools[pool_index(n)];
+        auto b = static_cast<impl::FreeBlock*>(p);
+        b->next = pool.free;
+        pool.free = b;
+    }
+
+    void* allocate(size_t n, const void* = nullptr) override
+    {
+        return allocate(n, granularity);
+    }
+
+    void deallocate(void* p, size_t n) noexcept override
+    {
+        deallocate(p, n, granularity);
+    }
+
+    void* allocate_aligned(size_t n, size_t alignment) override
+    {
+        return allocate(n, alignment);
+    }
+
+    void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override
+    {
+        deallocate(p, n, alignment);
+    }
+
+    void allocate_bulk(size_t n, size_t count, void** out) override
+    {
+        impl::allocate_each(*this, n, count, out);
+    }
+
+    void deallocate_bulk(void* const* p, size_t count, size_t n) noexcept override
+    {
+        impl::deallocate_each(*this, p, count, n);
+    }
+
+    size_t max_size() const noexcept override
+    {
+        return upstream->max_size();
+    }
+
+    poly_alloc_t* clone(poly_alloc_t& a) const override
+    {
+        return impl::poly_resource_ref<unsynchronized_pool>::clone_resource_ref(
+            const_cast<unsynchronized_pool&>(*this), a);
+    }
+
+    template<typename T = uint8_t>
+    allocator<T> get_allocator() noexcept
+    {
+        return allocator<T>(*this);
+    }
+
+    // returns all chunks and passed through blocks to upstream
+    void release() noexcept
+    {
+        for (auto& pool : pools) {
+            while (pool.chunks) {
+                auto c = pool.chunks;
+                pool.chunks = c->next;
+                upstream->deallocate(c, c->size);
+            }
+            pool = pool_t { };
+        }
+        while (large) {
+            deallocate_large(large + 1);
+        }
+    }
+
+    poly_alloc_t* upstream_resource() const noexcept
+    {
+        return upstream;
+    }
+
+    // the options in effect
+    pool_options_t options() const noexcept
+    {
+        return opts;
+    }
+
+private:
+    struct chunk_header {
+        chunk_header* next;
+        size_t size;
+    };
+
+    struct pool_t {
+        impl::FreeBlock* free;
+        uint8_t* current;
+        uint8_t* end;
+        chunk_header* chunks;
+        size_t next_blocks;
+    };
+
+    // in front of passed through blocks
+    struct large_header {
+        large_header* prev;
+        large_header* next;
+        void* raw;
+        size_t size;
+    };
+
+    static constexpr size_t chunk_header_size =
+        (sizeof(chunk_header) + granularity - 1) / granularity * granularity;
+
+    static pool_options_t normalize(pool_options_t options) noexcept
+    {
+        if (!options.max_blocks_per_chunk) {
+            options.max_blocks_per_chunk = default_max_blocks_per_chunk;
+        }
+        if (!options.largest_required_pool_block) {
+            options.largest_required_pool_block = default_largest_required_pool_block;
+        }
+        options.largest_required_pool_block = pool_block_size(
+            pool_index(options.largest_required_pool_block));
+        return options;
+    }
+
+    static size_t pool_index(size_t n) noexcept
+    {
+        return n <= granularity ? 0 :
+            impl::highest_bit(n - 1) + 1 - impl::log2(granularity);
+    }
+
+    static size_t pool_block_size(size_t index) noexcept
+    {
+        return granularity << index;
+    }
+
+    void new_chunk(pool_t& pool, size_t size)
+    {
+        auto blocks = pool.next_blocks ? pool.next_blocks :
+            ::std::min<size_t>(opts.max_blocks_per_chunk, 16);
+        auto bytes = chunk_header_size + blocks * size;
+        auto c = static_cast<chunk_header*>(upstream->allocate(bytes));
+        c->next = pool.chunks;
+        c->size = bytes;
+        pool.chunks = c;
+        pool.current = reinterpret_cast<uint8_t*>(c) + chunk_header_size;
+        pool.end = pool.current + blocks * size;
+        pool.next_blocks = ::std::min(blocks * 2, opts.max_blocks_per_chunk);
+    }
+
+    void* allocate_large(size_t n, size_t alignment)
+    {
+        alignment = ::std::max(alignment, granularity);
+        auto size = n + alignment + sizeof(large_header);
+        auto raw = static_cast<uint8_t*>(upstream->allocate(size));
+        auto p = impl::align_up(reinterpret_cast<uintptr_t>(raw + sizeof(large_header)), alignment);
+        auto h = reinterpret_cast<large_header*>(p) - 1;
+        h->prev = nullptr;
+        h->next = large;
+        h->raw = raw;
+        h->size = size;
+        if (large) {
+            large->prev = h;
+        }
+        large = h;
+        return h + 1;
+    }
+
+    void deallocate_large(void* p) noexcept
+    {
+        auto h = static_cast<large_header*>(p) - 1;
+        if (h->prev) {
+            h->prev->next = h->next;
+        } else {
+            large = h->next;
+        }
+        if (h->next) {
+            h->next->prev = h->prev;
+        }
+        upstream->deallocate(h->raw, h->size);
+    }
+
+    //////////////////////////
+    ///// member variables
+    /////////////////////////
+    poly_alloc_t* upstream;
+    pool_options_t opts;
+    ::std::vector<pool_t> pools;
+    large_header* large = nullptr;
+};
+
+constexpr size_t unsynchronized_pool::granularity;
+constexpr size_t unsynchronized_pool::default_max_blocks_per_chunk;
+constexpr size_t unsynchronized_pool::default_largest_required_pool_block;
+
+// unsynchronized_pool guarded by a mutex, thread_cache_t in front of it
+// takes the contention off the mutex
+class synchronized_pool : public poly_alloc_t {
+public:
+    template<typename T>
+    using allocator = resource_allocator<T, synchronized_pool>;
+
+    explicit synchronized_pool(
+        poly_alloc_t& upstream = default_poly_allocator::global(),
+        pool_options_t options = { }) :
+        pool { upstream, options }
+    {
+    }
+
+    void* allocate(size_t n, size_t alignment)
+    {
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        return pool.allocate(n, alignment);
+    }
+
+    void deallocate(void* p, size_t n, size_t alignment) noexcept
+    {
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        pool.deallocate(p, n, alignment);
+    }
+
+    void* allocate(size_t n, const void* = nullptr) override
+    {
+        return allocate(n, unsynchronized_pool::granularity);
+    }
+
+    void deallocate(void* p, size_t n) noexcept override
+    {
+        deallocate(p, n, unsynchronized_pool::granularity);
+    }
+
+    void* allocate_aligned(size_t n, size_t alignment) override
+    {
+        return allocate(n, alignment);
+    }
+
+    void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override
+    {
+        deallocate(p, n, alignment);
+    }
+
+    // the batch is served under a single lock
+    void allocate_bulk(size_t n, size_t count, void** out) override
+    {
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        pool.allocate_bulk(n, count, out);
+    }
+
+    void deallocate_bulk(void* const* p, size_t count, size_t n) noexcept override
+    {
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        pool.deallocate_bulk(p, count, n);
+    }
+
+    size_t max_size() const noexcept override
+    {
+        return pool.max_size();
+    }
+
+    poly_alloc_t* clone(poly_alloc_t& a) const override
+    {
+        return impl::poly_resource_ref<synchronized_pool>::clone_resource_ref(
+            const_cast<synchronized_pool&>(*this), a);
+    }
+
+    template<typename T = uint8_t>
+    allocator<T> get_allocator() noexcept
+    {
+        return allocator<T>(*this);
+    }
+
+    void release() noexcept
+    {
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        pool.release();
+    }
+
+    poly_alloc_t* upstream_resource() const noexcept
+    {
+        return pool.upstream_resource();
+    }
+
+    pool_options_t options() const noexcept
+    {
+        return pool.options();
+    }
+
+private:
+    //////////////////////////
+    ///// member variables
+    /////////////////////////
+    ::std::mutex mutex;
+    unsynchronized_pool pool;
+};
+
+// Free lists of nodes in front of a poly_alloc_t for node based containers
+// (e.g. std::list, std::map), one per size class up to max_node_size. An
+// empty free list is prefilled with batch_size nodes through allocate_bulk()
+// of upstream, the free nodes are returned by deallocate_bulk() on release()
+// and destruction. Larger and over-aligned requests pass through. Not
+// synchronized.
+class node_pool_t : public poly_alloc_t {
+public:
+    static constexpr size_t granularity = impl::size_class_granularity;
+    static constexpr size_t default_batch_size = 64;
+    static constexpr size_t default_max_node_size = 256;
+
+    template<typename T>
+    using allocator = resource_allocator<T, node_pool_t>;
+
+    explicit node_pool_t(
+        poly_alloc_t& upstream = default_poly_allocator::global(),
+        size_t batch_size = default_batch_size,
+        size_t max_node_size = default_max_node_size) :
+        upstream { &upstream }, batch_size { batch_size },
+        lists(impl::size_class_count(max_node_size))
+    {
+    }
+
+    node_pool_t(const node_pool_t&) = delete;
+    node_pool_t& operator=(const node_pool_t&) = delete;
+
+    // precondition: all nodes were deallocated
+    ~node_pool_t()
+    {
+        release();
+    }
+
+    void* allocate(size_t n, size_t alignment)
+    {
+        if (alignment > granularity) {
+            return upstream->allocate_aligned(n, alignment);
+        }
+        auto index = impl::size_class_index(n);
+        if (index >= lists.size()) {
+            return upstream->allocate(n);
+        }
+        auto& head = lists[index];
+        if (!head) {
+            size_t filled = 0;
+            try {
+                impl::fill_free_list(*upstream, impl::size_class_size(index),
+                    batch_size, head, filled);
+            } catch (...) {
+                if (!head) {
+                    throw;
+                }
+            }
+        }
+        auto b = head;
+        head = b->next;
+        return b;
+    }
+
+    // precondition: n and alignment are the same as on allocation
+    void deallocate(void* p, size_t n, size_t alignment) noexcept
+    {
+        if (alignment > granularity) {
+            return upstream->deallocate_aligned(p, n, alignment);
+        }
+        auto index = impl::size_class_index(n);
+        if (index >= lists.size()) {
+            return upstream->deallocate(p, n);
+        }
+        auto b = static_cast<impl::FreeBlock*>(p);
+        b->next = lists[index];
+        lists[index] = b;
+    }
+
+    void* allocate(size_t n, const void* = nullptr) override
+    {
+        return allocate(n, granularity);
+    }
+
+    void deallocate(void* p, size_t n) noexcept override
+    {
+        deallocate(p, n, granularity);
+    }
+
+    void* allocate_aligned(size_t n, size_t alignment) override
+    {
+        return allocate(n, alignment);
+    }
+
+    void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override
+    {
+        deallocate(p, n, alignment);
+    }
+
+    void allocate_bulk(size_t n, size_t count, void** out) override
+    {
+        impl::allocate_each(*this, n, count, out);
+    }
+
+    void deallocate_bulk(void* const* p, size_t count, size_t n) noexcept override
+    {
+        impl::deallocate_each(*this, p, count, n);
+    }
+
+    size_t max_size() const noexcept override
+    {
+        return upstream->max_size();
+    }
+
+    poly_alloc_t* clone(poly_alloc_t& a) const override
+    {
+        return impl::poly_resource_ref<node_pool_t>::clone_resource_ref(
+            const_cast<node_pool_t&>(*this), a);
+    }
+
+    template<typename T = uint8_t>
+    allocator<T> get_allocator() noexcept
+    {
+        return allocator<T>(*this);
+    }
+
+    // returns the free nodes to upstream
+    void release() noexcept
+    {
+        for (size_t i = 0; i < lists.size(); ++i) {
+            impl::drain_free_list(*upstream, impl::size_class_size(i),
+                ::std::numeric_limits<size_t>::max(), lists[i]);
+        }
+    }
+
+private:
+    //////////////////////////
+    ///// member variables
+    /////////////////////////
+    poly_alloc_t* upstream;
+    size_t batch_size;
+    ::std::vector<impl::FreeBlock*> lists;
+};
+
+constexpr size_t node_pool_t::granularity;
+
+// Decorator keeping per thread caches of free blocks for each size class in
+// front of an upstream poly_alloc_t. Caches are refilled from and flushed to
+// upstream in batches of batch_size blocks, a cache holds at most
+// cache_limit blocks per size class. Upstream is only accessed under a mutex
+// so it needn't be thread safe itself. The cache of a thread is flushed when
+// the thread exits or calls flush(). Blocks may be deallocated by any thread.
+class thread_cache_t : public poly_alloc_t {
+public:
+    static constexpr size_t granularity = impl::size_class_granularity;
+    static constexpr size_t default_max_cached_size = 256;
+    static constexpr size_t default_cache_limit = 64;
+    static constexpr size_t default_batch_size = 16;
+
+    template<typename T>
+    using allocator = resource_allocator<T, thread_cache_t>;
+
+    // precondition: 0 < batch_size <= cache_limit
+    explicit thread_cache_t(
+        poly_alloc_t& upstream = default_poly_allocator::global(),
+        size_t max_cached_size = default_max_cached_size,
+        size_t cache_limit = default_cache_limit,
+        size_t batch_size = default_batch_size) :
+        upstream { &upstream }, class_count { impl::size_class_count(max_cached_size) },
+        cache_limit { cache_limit }, batch_size { batch_size }
+    {
+    }
+
+    thread_cache_t(const thread_cache_t&) = delete;
+    thread_cache_t& operator=(const thread_cache_t&) = delete;
+
+    // Flushes the caches of all threads.
+    // precondition: no other thread uses the allocator anymore, bound threads
+    // may still be exiting
+    ~thread_cache_t()
+    {
+        bindings_t::release_all(mutex, caches);
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        for (auto& c : caches) {
+            flush_locked(*c);
+        }
+    }
+
+    void* allocate(size_t n, size_t alignment)
+    {
+        if (alignment > granularity) {
+            ::std::lock_guard<::std::mutex> lock { mutex };
+            return upstream->allocate_aligned(n, alignment);
+        }
+        auto index = impl::size_class_index(n);
+        auto c = index < class_count ? local_cache() : nullptr;
+        if (!c) {
+            // pooled sizes are rounded up so the block can join a cache later
+            auto size = index < class_count ? impl::size_class_size(index) : n;
+            ::std::lock_guard<::std::mutex> lock { mutex };
+            return upstream->allocate(size);
+        }
+        auto& bin = c->bins[index];
+        if (!bin.free) {
+            refill(bin, impl::size_class_size(index));
+        }
+        auto b = bin.free;
+        bin.free = b->next;
+        --bin.count;
+        return b;
+    }
+
+    // precondition: n and alignment are the same as on allocation
+    void deallocate(void* p, size_t n, size_t alignment) noexcept
+    {
+        if (alignment > granularity) {
+            ::std::lock_guard<::std::mutex> lock { mutex };
+            return upstream->deallocate_aligned(p, n, alignment);
+        }
+        auto index = impl::size_class_index(n);
+        auto c = index < class_count ? local_cache() : nullptr;
+        if (!c) {
+            // blocks of pooled sizes were allocated rounded up
+            auto size = index < class_count ? impl::size_class_size(index) : n;
+            ::std::lock_guard<::std::mutex> lock { mutex };
+            return upstream->deallocate(p, size);
+        }
+        auto& bin = c->bins[index];
+        auto b = static_cast<impl::FreeBlock*>(p);
+        b->next = bin.free;
+        bin.free = b;
+        if (++bin.count > cache_limit) {
+            ::std::lock_guard<::std::mutex> lock { mutex };
+            flush_locked(bin, impl::size_class_size(index), batch_size);
+        }
+    }
+
+    void* allocate(size_t n, const void* = nullptr) override
+    {
+        return allocate(n, granularity);
+    }
+
+    void deallocate(void* p, size_t n) noexcept override
+    {
+        deallocate(p, n, granularity);
+    }
+
+    void* allocate_aligned(size_t n, size_t alignment) override
+    {
+        return allocate(n, alignment);
+    }
+
+    void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override
+    {
+        deallocate(p, n, alignment);
+    }
+
+    void allocate_bulk(size_t n, size_t count, void** out) override
+    {
+        impl::allocate_each(*this, n, count, out);
+    }
+
+    void deallocate_bulk(void* const* p, size_t count, size_t n) noexcept override
+    {
+        impl::deallocate_each(*this, p, count, n);
+    }
+
+    size_t max_size() const noexcept override
+    {
+        return upstream->max_size();
+    }
+
+    poly_alloc_t* clone(poly_alloc_t& a) const override
+    {
+        return impl::poly_resource_ref<thread_cache_t>::clone_resource_ref(
+            const_cast<thread_cache_t&>(*this), a);
+    }
+
+    template<typename T = uint8_t>
+    allocator<T> get_allocator() noexcept
+    {
+        return allocator<T>(*this);
+    }
+
+    // returns the blocks cached by the calling thread to upstream
+    void flush() noexcept
+    {
+        auto b = bindings_t::local().find(this);
+        if (b) {
+            ::std::lock_guard<::std::mutex> lock { mutex };
+            flush_locked(*b->value);
+        }
+    }
+
+private:
+    struct bin_t {
+        impl::FreeBlock* free;
+        size_t count;
+    };
+
+    struct cache_t;
+    using bindings_t = impl::ThreadBindings<thread_cache_t, cache_t>;
+    friend bindings_t;
+
+    struct cache_t {
+        bindings_t::binding_t* bound;
+        ::std::unique_ptr<bin_t[]> bins;
+    };
+
+    // the cache of the calling thread, nullptr if it can't be created
+    cache_t* local_cache() noexcept
+    {
+        auto& local = bindings_t::local();
+        auto b = local.find(this);
+        if (b) {
+            return b->value;
+        }
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        try {
+            if (idle.empty()) {
+                caches.reserve(caches.size() + 1);
+                idle.reserve(caches.size() + 1);
+                caches.emplace_back(new cache_t { nullptr,
+                    ::std::unique_ptr<bin_t[]> { new bin_t[class_count]() } });
+                idle.push_back(caches.back().get());
+            }
+            b = &local.add(*this, idle.back());
+        } catch (...) {
+            return nullptr;
+        }
+        idle.pop_back();
+        b->value->bound = b;
+        return b->value;
+    }
+
+    // thread exit hook, the cache is kept for the next thread
+    void unbind(bindings_t::binding_t& b) noexcept
+    {
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        flush_locked(*b.value);
+        b.value->bound = nullptr;
+        idle.push_back(b.value);
+    }
+
+    void refill(bin_t& bin, size_t size)
+    {
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        size_t filled = 0;
+        try {
+            impl::fill_free_list(*upstream, size, batch_size, bin.free, filled);
+        } catch (...) {
+            bin.count += filled;
+            if (!bin.free) {
+                throw;
+            }
+            return;
+        }
+        bin.count += filled;
+    }
+
+    // precondition: mutex is locked
+    void flush_locked(bin_t& bin, size_t size, size_t count) noexcept
+    {
+        bin.count -= impl::drain_free_list(*upstream, size, count, bin.free);
+    }
+
+    // precondition: mutex is locked
+    void flush_locked(cache_t& c) noexcept
+    {
+        for (size_t i = 0; i < class_count; ++i) {
+            flush_locked(c.bins[i], impl::size_class_size(i), c.bins[i].count);
+        }
+    }
+
+    //////////////////////////
+    ///// member variables
+    /////////////////////////
+    poly_alloc_t* upstream;
+    size_t class_count;
+    size_t cache_limit;
+    size_t batch_size;
+    ::std::mutex mutex;
+    ::std::vector<::std::unique_ptr<cache_t>> caches;
+    // caches not bound to a thread, capacity is kept at caches.size()
+    ::std::vector<cache_t*> idle;
+};
+
+constexpr size_t thread_cache_t::granularity;
+
+// Snapshot of the statistics of a statistics_resource_t. Sizes are the
+// requested ones, histogram[i] counts the allocations of [2^i, 2^(i+1))
+// bytes, histogram[0] those of 0 bytes too.
+struct allocation_stats_t {
+    static constexpr size_t histogram_size = 64;
+
+    size_t live_bytes;
+    size_t peak_bytes;
+    size_t allocated_bytes;
+    size_t allocations;
+    size_t deallocations;
+    size_t histogram[histogram_size];
+
+    // one "name value" line per counter and per non-empty size class
+    ::std::string to_string() const
+    {
+        ::std::string text;
+        char line[96];
+        auto append = [&](const char* name, size_t value) {
+            ::std::snprintf(line, sizeof(line), "%s %zu\n", name, value);
+            text += line;
+        };
+        append("live_bytes", live_bytes);
+        append("peak_bytes", peak_bytes);
+        append("allocated_bytes", allocated_bytes);
+        append("allocations", allocations);
+        append("deallocations", deallocations);
+        for (size_t i = 0; i < histogram_size; ++i) {
+            if (histogram[i]) {
+                ::std::snprintf(line, sizeof(line), "size_2^%zu %zu\n", i, histogram[i]);
+                text += line;
+            }
+        }
+        return text;
+    }
+};
+
+constexpr size_t allocation_stats_t::histogram_size;
+
+// Decorator recording the live and peak bytes, the allocation counts and a
+// log2 size histogram of the requests to an upstream poly_alloc_t, e.g. to
+// tune the inline size of sso_storage_t or the size classes of the pools.
+// Each thread writes its own counters with relaxed stores, stats() sums
+// them. Live bytes are summed in a shared counter only after a thread's
+// balance moved by peak_granularity bytes or the thread exits, so
+// peak_bytes may miss peaks shorter than peak_granularity bytes per thread
+// (0 makes it exact for a single thread). Thread safe if upstream is.
+class statistics_resource_t : public poly_alloc_t {
+public:
+    static constexpr size_t default_peak_granularity = 4096;
+
+    template<typename T>
+    using allocator = resource_allocator<T, statistics_resource_t>;
+
+    explicit statistics_resource_t(
+        poly_alloc_t& upstream = default_poly_allocator::global(),
+        size_t peak_granularity = default_peak_granularity) :
+        upstream { &upstream },
+        peak_granularity { static_cast<ptrdiff_t>(peak_granularity) },
+        shared { new counters_t() }, live { 0 }, peak { 0 }
+    {
+    }
+
+    statistics_resource_t(const statistics_resource_t&) = delete;
+    statistics_resource_t& operator=(const statistics_resource_t&) = delete;
+
+    // precondition: no other thread uses the allocator anymore, bound threads
+    // may still be exiting
+    ~statistics_resource_t()
+    {
+        bindings_t::release_all(mutex, counters);
+    }
+
+    void* allocate(size_t n, size_t alignment)
+    {
+        auto p = upstream->allocate_aligned(n, alignment);
+        record_allocation(n, 1);
+        return p;
+    }
+
+    void deallocate(void* p, size_t n, size_t alignment) noexcept
+    {
+        upstream->deallocate_aligned(p, n, alignment);
+        record_deallocation(n, 1);
+    }
+
+    void* allocate(size_t n, const void* hint = nullptr) override
+    {
+        auto p = upstream->allocate(n, hint);
+        record_allocation(n, 1);
+        return p;
+    }
+
+    void deallocate(void* p, size_t n) noexcept override
+    {
+        upstream->deallocate(p, n);
+        record_deallocation(n, 1);
+    }
+
+    void* allocate_aligned(size_t n, size_t alignment) override
+    {
+        return allocate(n, alignment);
+    }
+
+    void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override
+    {
+        deallocate(p, n, alignment);
+    }
+
+    void allocate_bulk(size_t n, size_t count, void** out) override
+    {
+        upstream->allocate_bulk(n, count, out);
+        record_allocation(n, count);
+    }
+
+    void deallocate_bulk(void* const* p, size_t count, size_t n) noexcept override
+    {
+        upstream->deallocate_bulk(p, count, n);
+        record_deallocation(n, count);
+    }
+
+    size_t max_size() const noexcept override
+    {
+        return upstream->max_size();
+    }
+
+    poly_alloc_t* clone(poly_alloc_t& a) const override
+    {
+        return impl::poly_resource_ref<statistics_resource_t>::clone_resource_ref(
+            const_cast<statistics_resource_t&>(*this), a);
+    }
+
+    template<typename T = uint8_t>
+    allocator<T> get_allocator() noexcept
+    {
+        return allocator<T>(*this);
+    }
+
+    poly_alloc_t* upstream_resource() const noexcept
+    {
+        return upstream;
+    }
+
+    // sums the counters of all threads, a consistent snapshot if no other
+    // thread allocates meanwhile
+    allocation_stats_t stats() const
+    {
+        allocation_stats_t s {};
+        size_t deallocated = 0;
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        auto sum = [&](const counters_t& c) {
+            s.allocated_bytes += load(c.allocated_bytes);
+            deallocated += load(c.deallocated_bytes);
+            s.allocations += load(c.allocations);
+            s.deallocations += load(c.deallocations);
+            for (size_t i = 0; i < allocation_stats_t::histogram_size; ++i) {
+                s.histogram[i] += load(c.histogram[i]);
+            }
+        };
+        for (auto& c : counters) {
+            sum(*c);
+        }
+        sum(*shared);
+        s.live_bytes = s.allocated_bytes - deallocated;
+        s.peak_bytes = ::std::max(static_cast<size_t>(peak.load(::std::memory_order_relaxed)),
+            s.live_bytes);
+        return s;
+    }
+
+private:
+    struct counters_t;
+    using bindings_t = impl::ThreadBindings<statistics_resource_t, counters_t>;
+    friend bindings_t;
+
+    using counter_t = ::std::atomic<size_t>;
+
+    // written by the bound thread only, except the shared counters
+    struct counters_t {
+        bindings_t::binding_t* bound;
+        counter_t allocated_bytes;
+        counter_t deallocated_bytes;
+        counter_t allocations;
+        counter_t deallocations;
+        counter_t histogram[allocation_stats_t::histogram_size];
+        // change of the live bytes not yet added to the shared sum
+        ptrdiff_t unpublished;
+    };
+
+    static size_t load(const counter_t& c) noexcept
+    {
+        return c.load(::std::memory_order_relaxed);
+    }
+
+    static void add(counter_t& c, size_t n, bool exclusive) noexcept
+    {
+        if (exclusive) {
+            c.store(c.load(::std::memory_order_relaxed) + n, ::std::memory_order_relaxed);
+        } else {
+            c.fetch_add(n, ::std::memory_order_relaxed);
+        }
+    }
+
+    void record_allocation(size_t n, size_t count) noexcept
+    {
+        auto c = local_counters();
+        auto exclusive = c != nullptr;
+        if (!c) {
+            c = shared.get();
+        }
+        add(c->allocated_bytes, n * count, exclusive);
+        add(c->allocations, count, exclusive);
+        add(c->histogram[n ? impl::highest_bit(n) : 0], count, exclusive);
+        publish(*c, static_cast<ptrdiff_t>(n * count), exclusive);
+    }
+
+    void record_deallocation(size_t n, size_t count) noexcept
+    {
+        auto c = local_counters();
+        auto exclusive = c != nullptr;
+        if (!c) {
+            c = shared.get();
+        }
+        add(c->deallocated_bytes, n * count, exclusive);
+        add(c->deallocations, count, exclusive);
+        publish(*c, -static_cast<ptrdiff_t>(n * count), exclusive);
+    }
+
+    // adds the change of live bytes to the shared sum and raises the peak
+    void publish(counters_t& c, ptrdiff_t change, bool exclusive) noexcept
+    {
+        if (exclusive) {
+            c.unpublished += change;
+            if (c.unpublished < peak_granularity && -c.unpublished < peak_granularity) {
+                return;
+            }
+            change = c.unpublished;
+            c.unpublished = 0;
+        }
+        publish(change);
+    }
+
+    // the shared sum may go negative while a thread's frees of blocks
+    // allocated by other threads are published before their allocations
+    void publish(ptrdiff_t change) noexcept
+    {
+        auto now = live.fetch_add(change, ::std::memory_order_relaxed) + change;
+        if (change <= 0 || now <= 0) {
+            return;
+        }
+        auto highest = peak.load(::std::memory_order_relaxed);
+        while (now > highest &&
+            !peak.compare_exchange_weak(highest, now, ::std::memory_order_relaxed)) {
+        }
+    }
+
+    // the counters of the calling thread, nullptr if they can't be created
+    counters_t* local_counters() noexcept
+    {
+        auto& local = bindings_t::local();
+        auto b = local.find(this);
+        if (b) {
+            return b->value;
+        }
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        try {
+            if (idle.empty()) {
+                counters.reserve(counters.size() + 1);
+                idle.reserve(counters.size() + 1);
+                counters.emplace_back(new counters_t());
+                idle.push_back(counters.back().get());
+            }
+            b = &local.add(*this, idle.back());
+        } catch (...) {
+            return nullptr;
+        }
+        idle.pop_back();
+        b->value->bound = b;
+        return b->value;
+    }
+
+    // thread exit hook, publishes the balance of the thread, the counters
+    // are kept for the next thread
+    void unbind(bindings_t::binding_t& b) noexcept
+    {
+        publish(b.value->unpublished);
+        b.value->unpublished = 0;
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        b.value->bound = nullptr;
+        idle.push_back(b.value);
+    }
+
+    //////////////////////////
+    ///// member variables
+    /////////////////////////
+    poly_alloc_t* upstream;
+    ptrdiff_t peak_granularity;
+    mutable ::std::mutex mutex;
+    ::std::vector<::std::unique_ptr<counters_t>> counters;
+    // counters not bound to a thread, capacity is kept at counters.size()
+    ::std::vector<counters_t*> idle;
+    // updated by read-modify-write by threads without counters of their own
+    ::std::unique_ptr<counters_t> shared;
+    ::std::atomic<ptrdiff_t> live;
+    ::std::atomic<ptrdiff_t> peak;
+};
+
+// Pool of size class blocks for producer / consumer patterns, where blocks
+// are freed by other threads than the allocating one. Each thread allocates
+// from its own heap without locking. Blocks freed by other threads are
+// pushed onto the lock-free remote free list of the owning heap, which the
+// owner drains when a size class runs empty. Blocks are carved from slabs
+// aligned to slab_size, the slab header identifies the owning heap and the
+// size class, so the blocks themselves have no headers. The heap of an
+// exited thread is adopted by the next new thread. Slabs are obtained from
+// upstream in chunks under a mutex and returned when the pool is destroyed.
+// Larger and over-aligned requests are forwarded to upstream.
+class concurrent_pool_t : public poly_alloc_t {
+public:
+    static constexpr size_t granularity = impl::size_class_granularity;
+    static constexpr size_t default_max_pooled_size = 256;
+    static constexpr size_t default_slab_size = 16384;
+    static constexpr size_t slabs_per_chunk = 8;
+
+    template<typename T>
+    using allocator = resource_allocator<T, concurrent_pool_t>;
+
+    // precondition: slab_size is a power of 2 larger than max_pooled_size
+    // plus the slab header
+    explicit concurrent_pool_t(
+        poly_alloc_t& upstream = default_poly_allocator::global(),
+        size_t max_pooled_size = default_max_pooled_size,
+        size_t slab_size = default_slab_size) :
+        upstream { &upstream }, class_count { impl::size_class_count(max_pooled_size) },
+        slab_size { slab_size }
+    {
+    }
+
+    concurrent_pool_t(const concurrent_pool_t&) = delete;
+    concurrent_pool_t& operator=(const concurrent_pool_t&) = delete;
+
+    // precondition: no other thread uses the pool anymore, bound threads may
+    // still be exiting
+    ~concurrent_pool_t()
+    {
+        bindings_t::release_all(mutex, heaps);
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        for (auto c : chunks) {
+            upstream->deallocate_aligned(c, chunk_size(), slab_size);
+        }
+    }
+
+    void* allocate(size_t n, size_t alignment)
+    {
+        auto index = impl::size_class_index(n);
+        if (alignment > granularity || index >= class_count) {
+            ::std::lock_guard<::std::mutex> lock { mutex };
+            return alignment > granularity ?
+                upstream->allocate_aligned(n, alignment) :
+                upstream->allocate(n);
+        }
+        auto& h = local_heap();
+        auto& c = h.classes[index];
+        if (!c.free) {
+            drain_remote(h);
+        }
+        if (c.free) {
+            auto b = c.free;
+            c.free = b->next;
+            return b;
+        }
+        auto size = impl::size_class_size(index);
+        if (c.current == c.end) {
+            new_slab(h, c, size);
+        }
+        auto p = c.current;
+        c.current += size;
+        return p;
+    }
+
+    // precondition: n and alignment are the same as on allocation
+    void deallocate(void* p, size_t n, size_t alignment) noexcept
+    {
+        auto index = impl::size_class_index(n);
+        if (alignment > granularity || index >= class_count) {
+            ::std::lock_guard<::std::mutex> lock { mutex };
+            return alignment > granularity ?
+                upstream->deallocate_aligned(p, n, alignment) :
+                upstream->deallocate(p, n);
+        }
+        auto b = static_cast<impl::FreeBlock*>(p);
+        auto owner = slab_of(p)->owner;
+        auto local = bindings_t::local().find(this);
+        if (local && local->value == owner) {
+            auto& c = owner->classes[index];
+            b->next = c.free;
+            c.free = b;
+            return;
+        }
+        auto head = owner->remote.load(::std::memory_order_relaxed);
+        do {
+            b->next = head;
+        } while (!owner->remote.compare_exchange_weak(head, b,
+            ::std::memory_order_release, ::std::memory_order_relaxed));
+    }
+
+    void* allocate(size_t n, const void* = nullptr) override
+    {
+        return allocate(n, granularity);
+    }
+
+    void deallocate(void* p, size_t n) noexcept override
+    {
+        deallocate(p, n, granularity);
+    }
+
+    void* allocate_aligned(size_t n, size_t alignment) override
+    {
+        return allocate(n, alignment);
+    }
+
+    void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override
+    {
+        deallocate(p, n, alignment);
+    }
+
+    void allocate_bulk(size_t n, size_t count, void** out) override
+    {
+        impl::allocate_each(*this, n, count, out);
+    }
+
+    void deallocate_bulk(void* const* p, size_t count, size_t n) noexcept override
+    {
+        impl::deallocate_each(*this, p, count, n);
+    }
+
+    size_t max_size() const noexcept override
+    {
+        return upstream->max_size();
+    }
+
+    poly_alloc_t* clone(poly_alloc_t& a) const override
+    {
+        return impl::poly_resource_ref<concurrent_pool_t>::clone_resource_ref(
+            const_cast<concurrent_pool_t&>(*this), a);
+    }
+
+    template<typename T = uint8_t>
+    allocator<T> get_allocator() noexcept
+    {
+        return allocator<T>(*this);
+    }
+
+private:
+    struct heap_t;
+    using bindings_t = impl::ThreadBindings<concurrent_pool_t, heap_t>;
+    friend bindings_t;
+
+    struct size_class {
+        impl::FreeBlock* free;
+        uint8_t* current;
+        uint8_t* end;
+    };
+
+    struct heap_t {
+        // blocks freed by other threads
+        ::std::atomic<impl::FreeBlock*> remote;
+        bindings_t::binding_t* bound;
+        ::std::unique_ptr<size_class[]> classes;
+        // unused slabs of the last chunk
+        uint8_t* slabs;
+        uint8_t* slabs_end;
+    };
+
+    struct slab_header {
+        heap_t* owner;
+        size_t size;
+    };
+
+    static constexpr size_t header_size =
+        (sizeof(slab_header) + granularity - 1) / granularity * granularity;
+
+    slab_header* slab_of(void* p) const noexcept
+    {
+        return reinterpret_cast<slab_header*>(
+            reinterpret_cast<uintptr_t>(p) & ~(uintptr_t { slab_size } - 1));
+    }
+
+    size_t chunk_size() const noexcept
+    {
+        return slab_size * slabs_per_chunk;
+    }
+
+    heap_t& local_heap()
+    {
+        auto& local = bindings_t::local();
+        auto b = local.find(this);
+        if (b) {
+            return *b->value;
+        }
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        if (idle.empty()) {
+            heaps.reserve(heaps.size() + 1);
+            idle.reserve(heaps.size() + 1);
+            heaps.emplace_back(new heap_t { { nullptr }, nullptr,
+                ::std::unique_ptr<size_class[]> { new size_class[class_count]() },
+                nullptr, nullptr });
+            idle.push_back(heaps.back().get());
+        }
+        b = &local.add(*this, idle.back());
+        idle.pop_back();
+        b->value->bound = b;
+        return *b->value;
+    }
+
+    // thread exit hook, the heap is adopted by the next new thread
+    void unbind(bindings_t::binding_t& b) noexcept
+    {
+        ::std::lock_guard<::std::mutex> lock { mutex };
+        b.value->bound = nullptr;
+        idle.push_back(b.value);
+    }
+
+    void drain_remote(heap_t& h) noexcept
+    {
+        auto b = h.remote.exchange(nullptr, ::std::memory_order_acquire);
+        while (b) {
+            auto next = b->next;
+            auto& c = h.classes[impl::size_class_index(slab_of(b)->size)];
+            b->next = c.free;
+            c.free = b;
+            b = next;
+        }
+    }
+
+    void new_slab(heap_t& h, size_class& c, size_t size)
+    {
+        if (h.slabs == h.slabs_end) {
+            ::std::lock_guard<::std::mutex> lock { mutex };
+            chunks.reserve(chunks.size() + 1);
+            auto chunk = static_cast<uint8_t*>(
+                upstream->allocate_aligned(chunk_size(), slab_size));
+            chunks.push_back(chunk);
+            h.slabs = chunk;
+            h.slabs_end = chunk + chunk_size();
+        }
+        auto slab = h.slabs;
+        h.slabs += slab_size;
+        ::new (slab) slab_header { &h, size };
+        c.current = slab + header_size;
+        c.end = c.current + (slab_size - header_size) / size * size;
+    }
+
+    //////////////////////////
+    ///// member variables
+    /////////////////////////
+    poly_alloc_t* upstream;
+    size_t class_count;
+    size_t slab_size;
+    ::std::mutex mutex;
+    ::std::vector<::std::unique_ptr<heap_t>> heaps;
+    // heaps not bound to a thread, capacity is kept at heaps.size()
+    ::std::vector<heap_t*> idle;
+    ::std::vector<void*> chunks;
+};
+
+constexpr size_t concurrent_pool_t::granularity;
+constexpr size_t concurrent_pool_t::header_size;
+
+// Two-level segregated fit allocator managing a memory_resource_t region
+// with O(1) worst case allocation and deallocation, suited for real-time
+// threads. Free blocks are kept in size segregated lists, indexed by the
+// highest bit of the size (first level) and the next sl_log2 bits (second
+// level), with bitmaps locating a fitting non-empty list in constant time.
+// Adjacent free blocks are coalesced immediately. Each block has a header of
+// granularity bytes. Not synchronized. Throws bad_alloc when the region is
+// exhausted.
+class tlsf_t : public poly_alloc_t {
+public:
+    static constexpr size_t granularity =
+        alignof(::std::max_align_t) > 2 * sizeof(void*) ?
+            alignof(::std::max_align_t) : 2 * sizeof(void*);
+
+    template<typename T>
+    using allocator = resource_allocator<T, tlsf_t>;
+
+    explicit tlsf_t(memory_resource_t region)
+    {
+        auto begin = impl::align_up(reinterpret_cast<uintptr_t>(region.ptr()), granularity);
+        auto end = (reinterpret_cast<uintptr_t>(region.ptr()) + region.size())
+            & ~(uintptr_t { granularity } - 1);
+        if (end < begin + 2 * header_size + granularity) {
+            throw ::std::logic_error("memory resource too small for tlsf_t");
+        }
+        auto first = reinterpret_cast<block_t*>(begin);
+        first->header = end - begin - 2 * header_size;
+        // used block of size 0 terminating the region
+        next_phys(first)->header = 0;
+        set_free(first);
+        insert(first);
+    }
+
+    tlsf_t(const tlsf_t&) = delete;
+    tlsf_t& operator=(const tlsf_t&) = delete;
+
+    void* allocate(size_t n, size_t alignment)
+    {
+        if (n > max_request) {
+            throw ::std::bad_alloc { };
+        }
+        auto size = n <= granularity ? granularity : impl::align_up(n, granularity);
+        if (alignment <= granularity) {
+            auto b = find(size);
+            remove(b);
+            split(b, size);
+            set_used(b);
+            return payload(b);
+        }
+        // room for aligning the payload with a free block in front
+        auto b = find(size + alignment + header_size + granularity);
+        remove(b);
+        auto p = reinterpret_cast<uintptr_t>(payload(b));
+        auto gap = impl::align_up(p, alignment) - p;
+        if (gap && gap < header_size + granularity) {
+            gap = impl::align_up(p + header_size + granularity, alignment) - p;
+        }
+        if (gap) {
+            auto aligned = reinterpret_cast<block_t*>(p + gap - header_size);
+            aligned->header = block_size(b) - gap;
+            b->header = (gap - header_size) | (b->header & prev_free_bit);
+            set_free(b);
+            insert(b);
+            b = aligned;
+        }
+        split(b, size);
+        set_used(b);
+        return payload(b);
+    }
+
+    void deallocate(void* p, size_t, size_t) noexcept
+    {
+        auto b = reinterpret_cast<block_t*>(static_cast<uint8_t*>(p) - header_size);
+        if (b->header & prev_free_bit) {
+            auto prev = b->prev_phys;
+            remove(prev);
+            prev->header += header_size + block_size(b);
+            b = prev;
+        }
+        auto next = next_phys(b);
+        if (next->header & free_bit) {
+            remove(next);
+            b->header += header_size + block_size(next);
+        }
+        set_free(b);
+        insert(b);
+    }
+
+    void* allocate(size_t n, const void* = nullptr) override
+    {
+        return allocate(n, granularity);
+    }
+
+    void deallocate(void* p, size_t n) noexcept override
+    {
+        deallocate(p, n, granularity);
+    }
+
+    void* allocate_aligned(size_t n, size_t alignment) override
+    {
+        return allocate(n, alignment);
+    }
+
+    void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override
+    {
+        deallocate(p, n, alignment);
+    }
+
+    void allocate_bulk(size_t n, size_t count, void** out) override
+    {
+        impl::allocate_each(*this, n, count, out);
+    }
+
+    void deallocate_bulk(void* const* p, size_t count, size_t n) noexcept override
+    {
+        impl::deallocate_each(*this, p, count, n);
+    }
+
+    size_t max_size() const noexcept override
+    {
+        return max_request;
+    }
+
+    poly_alloc_t* clone(poly_alloc_t& a) const override
+    {
+        return impl::poly_resource_ref<tlsf_t>::clone_resource_ref(
+            const_cast<tlsf_t&>(*this), a);
+    }
+
+    template<typename T = uint8_t>
+    allocator<T> get_allocator() noexcept
+    {
+        return allocator<T>(*this);
+    }
+
+    // total size of the free blocks without their headers
+    size_t free_size() const noexcept
+    {
+        return free_bytes;
+    }
+
+private:
+    struct block_t {
+        // physical predecessor, valid if it is free
+        block_t* prev_phys;
+        // size of the payload and the flags
+        size_t header;
+        // free list links, inside the payload
+        block_t* next_free;
+        block_t* prev_free;
+    };
+
+    static constexpr size_t header_size = granularity;
+    static constexpr size_t free_bit = 1;
+    static constexpr size_t prev_free_bit = 2;
+    static constexpr size_t flag_mask = granularity - 1;
+    static constexpr size_t sl_log2 = 4;
+    static constexpr size_t sl_count = size_t { 1 } << sl_log2;
+    static constexpr size_t fl_shift = sl_log2 + impl::log2(granularity);
+    // sizes below are mapped linearly to the lists of the first level 0
+    static constexpr size_t small_block = size_t { 1 } << fl_shift;
+    static constexpr size_t fl_count = sizeof(size_t) * 8 - fl_shift + 1;
+    // the rounding of find() can't overflow below
+    static constexpr size_t max_request = size_t { 1 } << (sizeof(size_t) * 8 - 2);
+
+    static_assert(sizeof(block_t) <= header_size + granularity, "free list links don't fit");
+
+    static size_t block_size(const block_t* b) noexcept
+    {
+        return b->header & ~flag_mask;
+    }
+
+    static uint8_t* payload(block_t* b) noexcept
+    {
+        return reinterpret_cast<uint8_t*>(b) + header_size;
+    }
+
+    static block_t* next_phys(block_t* b) noexcept
+    {
+        return reinterpret_cast<block_t*>(payload(b) + block_size(b));
+    }
+
+    static void set_free(block_t* b) noexcept
+    {
+        b->header |= free_bit;
+        auto next = next_phys(b);
+        next->header |= prev_free_bit;
+        next->prev_phys = b;
+    }
+
+    static void set_used(block_t* b) noexcept
+    {
+        b->header &= ~free_bit;
+        next_phys(b)->header &= ~prev_free_bit;
+    }
+
+    static void mapping(size_t size, size_t& fl, size_t& sl) noexcept
+    {
+        if (size < small_block) {
+            fl = 0;
+            sl = size / granularity;
+        } else {
+            auto f = impl::highest_bit(size);
+            sl = (size >> (f - sl_log2)) ^ sl_count;
+            fl = f - fl_shift + 1;
+        }
+    }
+
+    // the first block of a list holding only blocks of at least size
+    block_t* find(size_t size)
+    {
+        if (size >= small_block) {
+            size += (size_t { 1 } << (impl::highest_bit(size) - sl_log2)) - 1;
+        }
+        size_t fl, sl;
+        mapping(size, fl, sl);
+        if (fl >= fl_count) {
+            throw ::std::bad_alloc { };
+        }
+        uint64_t sl_map = sl_bitmap[fl] & (~uint64_t { 0 } << sl);
+        if (!sl_map) {
+            auto fl_map = fl_bitmap & (~uint64_t { 0 } << (fl + 1));
+            if (!fl_map) {
+                throw ::std::bad_alloc { };
+            }
+            fl = impl::lowest_bit(fl_map);
+            sl_map = sl_bitmap[fl];
+        }
+        return free_lists[fl][impl::lowest_bit(sl_map)];
+    }
+
+    void insert(block_t* b) noexcept
+    {
+        size_t fl, sl;
+        mapping(block_size(b), fl, sl);
+        auto& head = free_lists[fl][sl];
+        b->prev_free = nullptr;
+        b->next_free = head;
+        if (head) {
+            head->prev_free = b;
+        }
+        head = b;
+        fl_bitmap |= uint64_t { 1 } << fl;
+        sl_bitmap[fl] |= 1U << sl;
+        free_bytes += block_size(b);
+    }
+
+    void remove(block_t* b) noexcept
+    {
+        size_t fl, sl;
+        mapping(block_size(b), fl, sl);
+        if (b->prev_free) {
+            b->prev_free->next_free = b->next_free;
+        } else {
+            free_lists[fl][sl] = b->next_free;
+        }
+        if (b->next_free) {
+            b->next_free->prev_free = b->prev_free;
+        }
+        if (!free_lists[fl][sl]) {
+            sl_bitmap[fl] &= ~(1U << sl);
+            if (!sl_bitmap[fl]) {
+                fl_bitmap &= ~(uint64_t { 1 } << fl);
+            }
+        }
+        free_bytes -= block_size(b);
+    }
+
+    // the remainder beyond size becomes a free block if it fits one
+    void split(block_t* b, size_t size) noexcept
+    {
+        auto total = block_size(b);
+        if (total < size + header_size + granularity) {
+            return;
+        }
+        b->header = size | (b->header & flag_mask);
+        auto rest = next_phys(b);
+        rest->header = total - size - header_size;
+        set_free(rest);
+        insert(rest);
+    }
+
+    //////////////////////////
+    ///// member variables
+    /////////////////////////
+    uint64_t fl_bitmap = 0;
+    uint32_t sl_bitmap[fl_count] = { };
+    block_t* free_lists[fl_count][sl_count] = { };
+    size_t free_bytes = 0;
+};
+
+constexpr size_t tlsf_t::granularity;
+constexpr size_t tlsf_t::small_block;
+
+// Buddy allocator managing a memory_resource_t region in blocks of
+// min_block << order bytes up to max_block. A block is split in halves
+// (buddies) on allocation and merged with its free buddy on deallocation.
+// Free blocks of each order are tracked by a bitmap, carved from the front
+// of the region, and an intrusive free list. The order of a block is derived
+// from the size passed to deallocate, blocks have no headers. Blocks are
+// aligned to their size up to the alignment of the managed area, which is
+// at least min_block. Not synchronized. Throws bad_alloc when no block is
+// large enough.
+template<size_t min_block = 4096, size_t max_block = 16 * 1024 * 1024>
+class buddy_resource_t : public poly_alloc_t {
+    static_assert(impl::is_power_of<2, min_block>::value, "min_block is not a power of 2");
+    static_assert(impl::is_power_of<2, max_block>::value, "max_block is not a power of 2");
+    static_assert(min_block <= max_block, "min_block is larger than max_block");
+    static_assert(min_block >= 2 * sizeof(void*), "min_block can't hold free list links");
+
+public:
+    static constexpr size_t min_order_shift = impl::log2(min_block);
+    static constexpr size_t order_count = impl::log2(max_block / min_block) + 1;
+
+    template<typename T>
+    using allocator = resource_allocator<T, buddy_resource_t>;
+
+    explicit buddy_resource_t(memory_resource_t region)
+    {
+        auto begin = reinterpret_cast<uintptr_t>(region.ptr());
+        auto end = begin + region.size();
+        // bitmaps for the whole region is an upper bound
+        size_t words = 0;
+        for (size_t order = 0; order < order_count; ++order) {
+            words += bitmap_words(region.size(), order);
+        }
+        auto bitmaps = reinterpret_cast<uint64_t*>(impl::align_up(begin, alignof(uint64_t)));
+        base = reinterpret_cast<uint8_t*>(
+            impl::align_up(reinterpret_cast<uintptr_t>(bitmaps + words), min_block));
+        if (reinterpret_cast<uintptr_t>(base) + min_block > end) {
+            throw ::std::logic_error("memory resource too small for buddy_resource_t");
+        }
+        managed = (end - reinterpret_cast<uintptr_t>(base)) & ~(size_t { min_block } - 1);
+        base_alignment = size_t { 1 } << impl::lowest_bit(reinterpret_cast<uintptr_t>(base));
+        ::std::fill(bitmaps, bitmaps + words, uint64_t { 0 });
+        for (size_t order = 0; order < order_count; ++order) {
+            bitmap[order] = bitmaps;
+            bitmaps += bitmap_words(region.size(), order);
+        }
+        // the largest blocks first keeps each block aligned to its size
+        size_t offset = 0;
+        for (size_t order = order_count; order-- > 0;) {
+            for (; managed - offset >= block_size(order); offset += block_size(order)) {
+                push(base + offset, order);
+            }
+        }
+        free_bytes = managed;
+    }
+
+    buddy_resource_t(const buddy_resource_t&) = delete;
+    buddy_resource_t& operator=(const buddy_resource_t&) = delete;
+
+    void* allocate(size_t n, size_t alignment)
+    {
+        auto order = order_for(n, alignment);
+        if (order >= order_count || alignment > base_alignment) {
+            throw ::std::bad_alloc { };
+        }
+        auto orders = nonempty >> order;
+        if (!orders) {
+            throw ::std::bad_alloc { };
+        }
+        auto k = order + impl::lowest_bit(orders);
+        auto b = free_lists[k];
+        remove(b, k);
+        while (k > order) {
+            --k;
+            push(reinterpret_cast<uint8_t*>(b) + block_size(k), k);
+        }
+        free_bytes -= block_size(order);
+        return b;
+    }
+
+    // precondition: n and alignment are the same as on allocation
+    void deallocate(void* p, size_t n, size_t alignment) noexcept
+    {
+        auto order = order_for(n, alignment);
+        free_bytes += block_size(order);
+        auto offset = static_cast<size_t>(static_cast<uint8_t*>(p) - base);
+        for (; order + 1 < order_count; ++order) {
+            auto buddy = offset ^ block_size(order);
+            if (buddy + block_size(order) > managed || !is_free(buddy, order)) {
+                break;
+            }
+            remove(reinterpret_cast<free_block_t*>(base + buddy), order);
+            offset &= ~block_size(order);
+        }
+        push(base + offset, order);
+    }
+
+    void* allocate(size_t n, const void* = nullptr) override
+    {
+        return allocate(n, alignof(::std::max_align_t));
+    }
+
+    void deallocate(void* p, size_t n) noexcept override
+    {
+        deallocate(p, n, alignof(::std::max_align_t));
+    }
+
+    void* allocate_aligned(size_t n, size_t alignment) override
+    {
+        return allocate(n, alignment);
+    }
+
+    void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override
+    {
+        deallocate(p, n, alignment);
+    }
+
+    void allocate_bulk(size_t n, size_t count, void** out) override
+    {
+        impl::allocate_each(*this, n, count, out);
+    }
+
+    void deallocate_bulk(void* const* p, size_t count, size_t n) noexcept override
+    {
+        impl::deallocate_each(*this, p, count, n);
+    }
+
+    size_t max_size() const noexcept override
+    {
+        return ::std::min(max_block, managed);
+    }
+
+    poly_alloc_t* clone(poly_alloc_t& a) const override
+    {
+        return impl::poly_resource_ref<buddy_resource_t>::clone_resource_ref(
+            const_cast<buddy_resource_t&>(*this), a);
+    }
+
+    template<typename T = uint8_t>
+    allocator<T> get_allocator() noexcept
+    {
+        return allocator<T>(*this);
+    }
+
+    // size of the block serving a request of n bytes
+    static size_t block_size_for(size_t n) noexcept
+    {
+        return block_size(order_for(n, 1));
+    }
+
+    // total size of the free blocks
+    size_t free_size() const noexcept
+    {
+        return free_bytes;
+    }
+
+    size_t largest_free_block() const noexcept
+    {
+        return nonempty ? block_size(impl::highest_bit(nonempty)) : 0;
+    }
+
+private:
+    struct free_block_t {
+        free_block_t* next;
+        free_block_t* prev;
+    };
+
+    static constexpr size_t block_size(size_t order) noexcept
+    {
+        return size_t { min_block } << order;
+    }
+
+    static size_t bitmap_words(size_t size, size_t order) noexcept
+    {
+        return ((size >> (min_order_shift + order)) + 64) / 64;
+    }
+
+    static size_t order_for(size_t n, size_t alignment) noexcept
+    {
+        n = ::std::max(n, alignment);
+        return n <= min_block ? 0 : impl::highest_bit(n - 1) + 1 - min_order_shift;
+    }
+
+    bool is_free(size_t offset, size_t order) const noexcept
+    {
+        auto i = offset >> (min_order_shift + order);
+        return (bitmap[order][i / 64] >> (i % 64)) & 1;
+    }
+
+    void flip(void* b, size_t order) noexcept
+    {
+        auto i = static_cast<size_t>(static_cast<uint8_t*>(b) - base) >> (min_order_shift + order);
+        bitmap[order][i / 64] ^= uint64_t { 1 } << (i % 64);
+    }
+
+    void push(void* p, size_t order) noexcept
+    {
+        auto b = static_cast<free_block_t*>(p);
+        auto& head = free_lists[order];
+        b->prev = nullptr;
+        b->next = head;
+        if (head) {
+            head->prev = b;
+        }
+        head = b;
+        nonempty |= uint64_t { 1 } << order;
+        flip(b, order);
+    }
+
+    void remove(free_block_t* b, size_t order) noexcept
+    {
+        if (b->prev) {
+            b->prev->next = b->next;
+        } else {
+            free_lists[order] = b->next;
+        }
+        if (b->next) {
+            b->next->prev = b->prev;
+        }
+        if (!free_lists[order]) {
+            nonempty &= ~(uint64_t { 1 } << order);
+        }
+        flip(b, order);
+    }
+
+    //////////////////////////
+    ///// member variables
+    /////////////////////////
+    uint8_t* base;
+    size_t managed;
+    size_t base_alignment;
+    size_t free_bytes;
+    // bit of each order set if a free list is not empty
+    uint64_t nonempty = 0;
+    uint64_t* bitmap[order_count];
+    free_block_t* free_lists[order_count] = { };
+};
+
+template<size_t min_block, size_t max_block>
+constexpr size_t buddy_resource_t<min_block, max_block>::min_order_shift;
+template<size_t min_block, size_t max_block>
+constexpr size_t buddy_resource_t<min_block, max_block>::order_count;
+
+// Options of map_memory(), each is best effort
+struct mapping_options_t {
+    // MAP_HUGETLB, falling back to transparent huge pages by madvise
+    bool huge_pages = true;
+    // page faults up front, by MAP_POPULATE or touching each page
+    bool populate = false;
+    // keeps the pages in RAM by mlock, subject to RLIMIT_MEMLOCK
+    bool lock = false;
+};
+
+// Owning block of memory mapped from the OS, resource() can back arenas and
+// pools built on memory_resource_t. Unmapped on destruction.
+class mapped_memory_t {
+public:
+    static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+    mapped_memory_t() noexcept = default;
+
+    mapped_memory_t(mapped_memory_t&& rhs) noexcept
+    {
+        swap(rhs);
+    }
+
+    mapped_memory_t& operator=(mapped_memory_t&& rhs) noexcept
+    {
+        mapped_memory_t tmp { ::std::move(rhs) };
+        swap(tmp);
+        return *this;
+    }
+
+    ~mapped_memory_t()
+    {
+        if (!p) {
+            return;
+        }
+#if defined(__unix__) || defined(__APPLE__)
+        if (is_locked) {
+            ::munlock(p, n);
+        }
+        ::munmap(p, n);
+#else
+        ::operator delete(p);
+#endif
+    }
+
+    void swap(mapped_memory_t& rhs) noexcept
+    {
+        using ::std::swap;
+        swap(p, rhs.p);
+        swap(n, rhs.n);
+        swap(has_huge_pages, rhs.has_huge_pages);
+        swap(is_huge_pages_advised, rhs.is_huge_pages_advised);
+        swap(is_populated, rhs.is_populated);
+        swap(is_locked, rhs.is_locked);
+    }
+
+    memory_resource_t resource() const
+    {
+        return p ? memory_resource_t { p, n } : memory_resource_t { };
+    }
+
+    void* data() const noexcept
+    {
+        return p;
+    }
+
+    // the requested size rounded up to whole pages
+    size_t size() const noexcept
+    {
+        return n;
+    }
+
+    // backed by explicit huge pages (MAP_HUGETLB)
+    bool huge_pages() const noexcept
+    {
+        return has_huge_pages;
+    }
+
+    // transparent huge pages were requested by madvise, the kernel may
+    // still back the range by normal pages (e.g. THP set to never)
+    bool huge_pages_advised() const noexcept
+    {
+        return is_huge_pages_advised;
+    }
+
+    bool populated() const noexcept
+    {
+        return is_populated;
+    }
+
+    bool locked() const noexcept
+    {
+        return is_locked;
+    }
+
+    friend mapped_memory_t map_memory(size_t n, mapping_options_t options);
+
+private:
+    //////////////////////////
+    ///// member variables
+    /////////////////////////
+    void* p = nullptr;
+    size_t n = 0;
+    bool has_huge_pages = false;
+    bool is_huge_pages_advised = false;
+    bool is_populated = false;
+    bool is_locked = false;
+};
+
+// Maps n bytes of private anonymous memory. Options that aren't available
+// on the platform or denied by the OS are silently dropped, see the getters
+// of the result. Throws bad_alloc if no memory can be mapped at all.
+inline mapped_memory_t map_memory(size_t n, mapping_options_t options = { })
+{
+    mapped_memory_t m;
+    n += n == 0;
+#if defined(__unix__) || defined(__APPLE__)
+    constexpr auto huge = mapped_memory_t::huge_page_size;
+    constexpr int prot = PROT_READ | PROT_WRITE;
+    constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    int populate = 0;
+#if defined(MAP_POPULATE)
+    populate = options.populate ? MAP_POPULATE : 0;
+#endif
+#if defined(MAP_HUGETLB)
+    if (options.huge_pages) {
+        auto size = impl::align_up(n, huge);
+        auto p = ::mmap(nullptr, size, prot, flags | MAP_HUGETLB | populate, -1, 0);
+        if (p != MAP_FAILED) {
+            m.p = p;
+            m.n = size;
+            m.has_huge_pages = true;
+            m.is_populated = populate != 0;
+        }
+    }
+#endif
+    auto touch_pages = [&m] {
+        auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        auto bytes = static_cast<volatile uint8_t*>(m.p);
+        for (size_t i = 0; i < m.n; i += page) {
+            bytes[i] = 0;
+        }
+        m.is_populated = true;
+    };
+    if (!m.p && options.huge_pages) {
+        // transparent huge pages need huge page aligned ranges, the excess
+        // of the larger mapping is trimmed, falls back to normal pages if
+        // it can't be mapped
+        auto size = impl::align_up(n, huge);
+        auto raw = ::mmap(nullptr, size + huge, prot, flags, -1, 0);
+        if (raw != MAP_FAILED) {
+            auto begin = reinterpret_cast<uintptr_t>(raw);
+            auto aligned = impl::align_up(begin, huge);
+            if (aligned != begin) {
+                ::munmap(raw, aligned - begin);
+            }
+            // aligned < begin + huge, there is always a tail
+            ::munmap(reinterpret_cast<void*>(aligned + size), begin + huge - aligned);
+            m.p = reinterpret_cast<void*>(aligned);
+            m.n = size;
+#if defined(MADV_HUGEPAGE)
+            m.is_huge_pages_advised = ::madvise(m.p, m.n, MADV_HUGEPAGE) == 0;
+#endif
+            // MAP_POPULATE would fault in normal pages before the advice
+            if (options.populate) {
+                touch_pages();
+            }
+        }
+    }
+    if (!m.p) {
+        auto size = impl::align_up(n, static_cast<size_t>(::sysconf(_SC_PAGESIZE)));
+        auto p = ::mmap(nullptr, size, prot, flags | populate, -1, 0);
+        if (p == MAP_FAILED) {
+            throw ::std::bad_alloc { };
+        }
+        m.p = p;
+        m.n = size;
+        m.is_populated = populate != 0;
+    }
+    // without MAP_POPULATE
+    if (options.populate && !m.is_populated) {
+        touch_pages();
+    }
+    if (options.lock) {
+        m.is_locked = ::mlock(m.p, m.n) == 0;
+    }
+#else
+    (void)options;
+    m.p = ::operator new(n);
+    m.n = n;
+#endif
+    return m;
+}
+
+}  // namespace estd
+
+#endif  /* MEMORY_RESOURCE_H_ */
@@ -0,0 +1,657 @@
+// Copyright (c) 2016 Ferenc Nandor Janky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef VECTOR_H_
+#define VECTOR_H_
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "memory.h"
+
+namespace estd {
+
+namespace impl {
+
+template<typename T>
+void destroy_range(T* first, T* last) noexcept
+{
+    for (; first != last; ++first) {
+        first->~T();
+    }
+}
+
+// moves n objects from src to uninitialized dest and destroys the sources
+template<typename T>
+void relocate(T* dest, T* src, size_t n, ::std::true_type) noexcept
+{
+    if (n > 0) {
+        ::std::memcpy(static_cast<void*>(dest), static_cast<const void*>(src),
+            n * sizeof(T));
+    }
+}
+
+// strong guarantee if T is nothrow move constructible or copy constructible
+template<typename T>
+void relocate(T* dest, T* src, size_t n, ::std::false_type)
+{
+    size_t i = 0;
+    try {
+        for (; i < n; ++i) {
+            ::new (static_cast<void*>(dest + i)) T(::std::move_if_noexcept(src[i]));
+        }
+    }
+    catch (...) {
+        destroy_range(dest, dest + i);
+        throw;
+    }
+    destroy_range(src, src + n);
+}
+
+template<typename T>
+void relocate(T* dest, T* src, size_t n)
+    noexcept(is_trivially_relocatable<T>::value)
+{
+    relocate(dest, src, n, typename is_trivially_relocatable<T>::type {});
+}
+
+}  // namespace impl
+
+// Vector that stores the first N elements in the inline buffer of an
+// sso_storage_t and spills to the heap through Allocator above that
+template<
+    typename T,
+    size_t N,
+    class Allocator = ::std::allocator<T>
+>
+class small_vector {
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = size_t;
+    using difference_type = ::std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using reverse_iterator = ::std::reverse_iterator<iterator>;
+    using const_reverse_iterator = ::std::reverse_iterator<const_iterator>;
+
+    using byte_allocator_type = typename ::std::allocator_traits<
+        allocator_type>::template rebind_alloc<::std::uint8_t>;
+    using storage_t = sso_storage_t<
+        (N * sizeof(T) + sizeof(void*) - 1) / sizeof(void*),
+        alignof(T),
+        byte_allocator_type,
+        UnionLayoutPolicy
+        >;
+
+    using pocca = typename storage_t::pocca;
+    using pocma = typename storage_t::pocma;
+    using pocs = typename storage_t::pocs;
+
+    static constexpr size_type inline_capacity = storage_t::max_size() / sizeof(T);
+
+    small_vector() noexcept(
+        ::std::is_nothrow_default_constructible<byte_allocator_type>::value) :
+        storage { }, size_ { }
+    {
+    }
+
+    explicit small_vector(const allocator_type& a) :
+        storage { ::std::allocator_arg, byte_allocator_type(a) }, size_ { }
+    {
+    }
+
+    explicit small_vector(size_type n, const allocator_type& a = allocator_type()) :
+        small_vector(a)
+    {
+        resize(n);
+    }
+
+    small_vector(size_type n, const T& value, const allocator_type& a = allocator_type()) :
+        small_vector(a)
+    {
+        resize(n, value);
+    }
+
+    template<
+        class InputIt,
+        typename = ::std::enable_if_t<!::std::is_integral<InputIt>::value>
+    >
+    small_vector(InputIt first, InputIt last, const allocator_type& a = allocator_type()) :
+        small_vector(a)
+    {
+        append(first, last);
+    }
+
+    small_vector(::std::initializer_list<T> il, const allocator_type& a = allocator_type()) :
+        small_vector(il.begin(), il.end(), a)
+    {
+    }
+
+    small_vector(const small_vector& rhs) :
+        storage { ::std::allocator_arg,
+            ::std::allocator_traits<byte_allocator_type>::
+                select_on_container_copy_construction(rhs.storage.get_allocator()) },
+        size_ { }
+    {
+        append(rhs.begin(), rhs.end());
+    }
+
+    // inline allocated elements are relocated one by one, heap storage
+    // is taken over
+    small_vector(small_vector&& rhs)
+        noexcept(::std::is_nothrow_move_constructible<T>::value) :
+        storage { ::std::move(rhs.storage) }, size_ { }
+    {
+        if (rhs.storage) {
+            impl::relocate(data(), rhs.data(), rhs.size_);
+        }
+        size_ = rhs.size_;
+        rhs.size_ = 0;
+    }
+
+    small_vector& operator=(const small_vector& rhs)
+    {
+        if (this != &rhs) {
+            copy_assign_impl(rhs, pocca { });
+        }
+        return *this;
+    }
+
+    small_vector& operator=(small_vector&& rhs) noexcept(
+        storage_t::move_assign_noexcept &&
+        ::std::is_nothrow_move_constructible<T>::value)
+    {
+        if (this != &rhs) {
+            clear();
+            const auto rhs_data = rhs.data();
+            storage = ::std::move(rhs.storage);
+            // storage was not taken over if rhs was inline allocated or
+            // allocators compare unequal without propagation
+            if (data() != rhs_data) {
+                impl::relocate(data(), rhs_data, rhs.size_);
+            }
+            size_ = rhs.size_;
+            rhs.size_ = 0;
+        }
+        return *this;
+    }
+
+    small_vector& operator=(::std::initializer_list<T> il)
+    {
+        assign(il);
+        return *this;
+    }
+
+    ~small_vector()
+    {
+        clear();
+    }
+
+    template<class ForwardIt>
+    void assign(ForwardIt first, ForwardIt last)
+    {
+        const auto n = static_cast<size_type>(::std::distance(first, last));
+        if (n > capacity()) {
+            clear();
+            storage.deallocate();
+            reserve(n);
+            append(first, last);
+        } else if (n > size_) {
+            auto mid = ::std::next(first, size_);
+            ::std::copy(first, mid, begin());
+            append(mid, last);
+        } else {
+            auto new_end = ::std::copy(first, last, begin());
+            impl::destroy_range(new_end, end());
+            size_ = n;
+        }
+    }
+
+    void assign(::std::initializer_list<T> il)
+    {
+        assign(il.begin(), il.end());
+    }
+
+    allocator_type get_allocator() const
+    {
+        return allocator_type(storage.get_allocator());
+    }
+
+    reference at(size_type i)
+    {
+        range_check(i);
+        return data()[i];
+    }
+
+    const_reference at(size_type i) const
+    {
+        range_check(i);
+        return data()[i];
+    }
+
+    reference operator[](size_type i) noexcept
+    {
+        return data()[i];
+    }
+
+    const_reference operator[](size_type i) const noexcept
+    {
+        return data()[i];
+    }
+
+    reference front() noexcept
+    {
+        return *begin();
+    }
+
+    const_reference front() const noexcept
+    {
+        return *begin();
+    }
+
+    reference back() noexcept
+    {
+        return *(end() - 1);
+    }
+
+    const_reference back() const noexcept
+    {
+        return *(end() - 1);
+    }
+
+    T* data() noexcept
+    {
+        return static_cast<T*>(storage.get());
+    }
+
+    const T* data() const noexcept
+    {
+        return static_cast<const T*>(storage.get());
+    }
+
+    iterator begin() noexcept
+    {
+        return data();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return data();
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return data();
+    }
+
+    iterator end() noexcept
+    {
+        return data() + size_;
+    }
+
+    const_iterator end() const noexcept
+    {
+        return data() + size_;
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return data() + size_;
+    }
+
+    reverse_iterator rbegin() noexcept
+    {
+        return reverse_iterator(end());
+    }
+
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return const_reverse_iterator(end());
+    }
+
+    reverse_iterator rend() noexcept
+    {
+        return reverse_iterator(begin());
+    }
+
+    const_reverse_iterator rend() const noexcept
+    {
+        return const_reverse_iterator(begin());
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    size_type size() const noexcept
+    {
+        return size_;
+    }
+
+    size_type max_size() const noexcept
+    {
+        return ::std::allocator_traits<byte_allocator_type>::max_size(
+            storage.get_allocator()) / sizeof(T);
+    }
+
+    size_type capacity() const noexcept
+    {
+        return storage ? storage.capacity() / sizeof(T) : inline_capacity;
+    }
+
+    // true if the elements are stored in the inline buffer
+    bool is_inline() const noexcept
+    {
+        return storage.size() <= storage_t::max_size();
+    }
+
+    void reserve(size_type n)
+    {
+        if (n > max_size()) {
+            throw ::std::length_error("small_vector: reserve exceeds max_size");
+        }
+        if (storage && n <= capacity()) {
+            return;
+        }
+        storage.reallocate(n * sizeof(T), [this](void* dest, void* src) {
+            impl::relocate(static_cast<T*>(dest), static_cast<T*>(src), size_);
+        });
+    }
+
+    void clear() noexcept
+    {
+        impl::destroy_range(begin(), end());
+        size_ = 0;
+    }
+
+    void push_back(const T& value)
+    {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value)
+    {
+        emplace_back(::std::move(value));
+    }
+
+    template<typename... Args>
+    reference emplace_back(Args&&... args)
+    {
+        if (!storage || size_ == capacity()) {
+            // args may refer to an element of this vector
+            T temp(::std::forward<Args>(args)...);
+            reserve(recommended_capacity(size_ + 1));
+            ::new (static_cast<void*>(end())) T(::std::move(temp));
+        } else {
+            ::new (static_cast<void*>(end())) T(::std::forward<Args>(args)...);
+        }
+        ++size_;
+        return back();
+    }
+
+    template<typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args)
+    {
+        const auto i = pos - cbegin();
+        emplace_back(::std::forward<Args>(args)...);
+        ::std::rotate(begin() + i, end() - 1, end());
+        return begin() + i;
+    }
+
+    iterator insert(const_iterator pos, const T& value)
+    {
+        return emplace(pos, value);
+    }
+
+    iterator insert(const_iterator pos, T&& value)
+    {
+        return emplace(pos, ::std::move(value));
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return erase(pos, pos + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        auto f = begin() + (first - cbegin());
+        auto l = begin() + (last - cbegin());
+        if (f != l) {
+            auto new_end = ::std::move(l, end(), f);
+            impl::destroy_range(new_end, end());
+            size_ = static_cast<size_type>(new_end - begin());
+        }
+        return f;
+    }
+
+    void pop_back() noexcept
+    {
+        --size_;
+        end()->~T();
+    }
+
+    void resize(size_type n)
+    {
+        resize_impl(n, [](T* p) { ::new (static_cast<void*>(p)) T(); });
+    }
+
+    void resize(size_type n, const T& value)
+    {
+        resize_impl(n, [&value](T* p) { ::new (static_cast<void*>(p)) T(value); });
+    }
+
+    void swap(small_vector& rhs) noexcept(
+        storage_t::swap_noexcept &&
+        ::std::is_nothrow_move_constructible<T>::value &&
+        ::std::is_nothrow_move_assignable<T>::value)
+    {
+        if (this == &rhs) {
+            return;
+        }
+        swap_check(rhs, ::std::integral_constant<bool, storage_t::swap_noexcept> { });
+        if (!is_inline() && !rhs.is_inline()) {
+            storage.swap_object(rhs.storage);
+            ::std::swap(size_, rhs.size_);
+        } else if (!is_inline()) {
+            swap_w_inline_allocated(*this, rhs);
+        } else if (!rhs.is_inline()) {
+            swap_w_inline_allocated(rhs, *this);
+        } else {
+            swap_inline_allocated(rhs);
+        }
+    }
+
+private:
+    void range_check(size_type i) const
+    {
+        if (i >= size_) {
+            throw ::std::out_of_range("small_vector: index out of range");
+        }
+    }
+
+    void swap_check(const small_vector&, ::std::true_type) noexcept
+    {
+    }
+
+    void swap_check(const small_vector& rhs, ::std::false_type)
+    {
+        if (!allocators_equal(rhs)) {
+            throw ::std::runtime_error(
+                "small_vector: swap attempt with unequal allocators");
+        }
+    }
+
+    size_type recommended_capacity(size_type n) const noexcept
+    {
+        return storage ?
+            ::std::max(n, 2 * capacity()) :
+            ::std::max(n, inline_capacity);
+    }
+
+    bool allocators_equal(const small_vector& rhs) const noexcept
+    {
+        return impl::allocator_is_always_equal<byte_allocator_type>::value ||
+            storage.get_allocator() == rhs.storage.get_allocator();
+    }
+
+    template<class InputIt>
+    void append(InputIt first, InputIt last, ::std::input_iterator_tag)
+    {
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+
+    template<class ForwardIt>
+    void append(ForwardIt first, ForwardIt last, ::std::forward_iterator_tag)
+    {
+        const auto n = static_cast<size_type>(::std::distance(first, last));
+        reserve(size_ + n);
+        ::std::uninitialized_copy(first, last, end());
+        size_ += n;
+    }
+
+    template<class InputIt>
+    void append(InputIt first, InputIt last)
+    {
+        append(first, last,
+            typename ::std::iterator_traits<InputIt>::iterator_category { });
+    }
+
+    template<typename Construct>
+    void resize_impl(size_type n, Construct construct)
+    {
+        if (n < size_) {
+            impl::destroy_range(begin() + n, end());
+            size_ = n;
+        } else {
+            reserve(n);
+            while (size_ < n) {
+                construct(end());
+                ++size_;
+            }
+        }
+    }
+
+    void copy_assign_impl(const small_vector& rhs, ::std::true_type)
+    {
+        // memory has to be released with the allocator that obtained it
+        if (!allocators_equal(rhs)) {
+            clear();
+            storage.deallocate();
+        }
+        storage.get_allocator() = rhs.storage.get_allocator();
+        assign(rhs.begin(), rhs.end());
+    }
+
+    void copy_assign_impl(const small_vector& rhs, ::std::false_type)
+    {
+        assign(rhs.begin(), rhs.end());
+    }
+
+    // precondition: both vectors are inline allocated or unallocated
+    void swap_inline_allocated(small_vector& rhs)
+    {
+        using std::swap;
+        reserve(inline_capacity);
+        rhs.reserve(inline_capacity);
+        if (pocs::value) {
+            swap(storage.get_allocator(), rhs.storage.get_allocator());
+        }
+        auto& shorter = size_ < rhs.size_ ? *this : rhs;
+        auto& longer = size_ < rhs.size_ ? rhs : *this;
+        const auto n = shorter.size_;
+        ::std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+        impl::relocate(shorter.data() + n, longer.data() + n, longer.size_ - n);
+        swap(size_, rhs.size_);
+    }
+
+    // The heap pointer overlays the inline buffer, so elements of the inline
+    // allocated vector are relocated to a temporary before the storages
+    // are swapped
+    static void swap_w_inline_allocated(small_vector& allocated, small_vector& inl)
+    {
+        small_vector temp(inl.get_allocator());
+        temp.reserve(inline_capacity);
+        impl::relocate(temp.data(), inl.data(), inl.size_);
+        temp.size_ = inl.size_;
+        inl.size_ = 0;
+        allocated.storage.swap_object(inl.storage);
+        ::std::swap(allocated.size_, inl.size_);
+        allocated.reserve(inline_capacity);
+        impl::relocate(allocated.data(), temp.data(), temp.size_);
+        allocated.size_ = temp.size_;
+        temp.size_ = 0;
+    }
+
+    //////////////////////////
+    ///// member variables
+    /////////////////////////
+    storage_t storage;
+    size_type size_;
+};
+
+template<typename T, size_t N, class A>
+constexpr typename small_vector<T, N, A>::size_type small_vector<T, N, A>::inline_capacity;
+
+template<typename T, size_t N, class A>
+bool operator==(const small_vector<T, N, A>& lhs, const small_vector<T, N, A>& rhs)
+{
+    return lhs.size() == rhs.size() &&
+        ::std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template<typename T, size_t N, class A>
+bool operator!=(const small_vector<T, N, A>& lhs, const small_vector<T, N, A>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+template<typename T, size_t N, class A>
+bool operator<(const small_vector<T, N, A>& lhs, const small_vector<T, N, A>& rhs)
+{
+    return ::std::lexicographical_compare(lhs.begin(), lhs.end(),
+        rhs.begin(), rhs.end());
+}
+
+template<typename T, size_t N, class A>
+inline void swap(small_vector<T, N, A>& lhs, small_vector<T, N, A>& rhs)
+noexcept(noexcept(lhs.swap(rhs)))
+{
+    lhs.swap(rhs);
+}
+
+}  // namespace estd
+
+#endif /* VECTOR_H_ */
@@ -136,6 +136,58 @@ namespace Mock {
 
     };
 
+    // Byte allocator providing the allocate(n, alignment) extension
+    template<
+        typename T,
+        class PropOnCCopy = std::true_type,
+        class PropOnCMove = std::true_type,
+        class PropOnCSwap = std::true_type
+    > class AlignedAllocatorMock :
+        public AllocatorMock<T, PropOnCCopy, PropOnCMove, PropOnCSwap> {
+    public:
+        using Base = AllocatorMock<T, PropOnCCopy, PropOnCMove, PropOnCSwap>;
+        using pointer = typename Base::pointer;
+        using size_type = typename Base::size_type;
+
+        AlignedAllocatorMock() {}
+        AlignedAllocatorMock(const AlignedAllocatorMock& a) : Base(a) {}
+        AlignedAllocatorMock(AlignedAllocatorMock&& a) noexcept : Base(std::move(a)) {}
+
+        AlignedAllocatorMock& operator=(const AlignedAllocatorMock& a) noexcept {
+            Base::operator=(a);
+            return *this;
+        }
+
+        AlignedAllocatorMock& operator=(AlignedAllocatorMock&& a) noexcept {
+            Base::operator=(std::move(a));
+            return *this;
+        }
+
+        //////////////////////
+        /// Mocked methods
+        //////////////////////
+        MOCK_METHOD2_T(allocate, pointer(size_type, size_type));
+        MOCK_METHOD3_T(deallocate, void(pointer, size_type, size_type));
+    };
+
+    // Byte allocator providing the try_expand(p, n, new_n) extension
+    template<typename T>
+    class ExpandingAllocatorMock : public AllocatorMock<T> {
+    public:
+        using Base = AllocatorMock<T>;
+        using pointer = typename Base::pointer;
+        using size_type = typename Base::size_type;
+
+        ExpandingAllocatorMock() {}
+        ExpandingAllocatorMock(const ExpandingAllocatorMock& a) : Base(a) {}
+        ExpandingAllocatorMock(ExpandingAllocatorMock&& a) noexcept : Base(std::move(a)) {}
+
+        //////////////////////
+        /// Mocked methods
+        //////////////////////
+        MOCK_METHOD3_T(try_expand, bool(pointer, size_type, size_type));
+    };
+
     template<typename T,class C,class M, class S>
     inline void swap(Mock::AllocatorMock<T,C,M,S>& lhs, Mock::AllocatorMock<T, C, M, S>& rhs) noexcept
     {
@@ -4,6 +4,8 @@
 #include <tuple>
 #include <cmath>
 #include <cstdint>
+#include <algorithm>
+#include <iterator>
 
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
@@ -45,12 +47,24 @@ struct Size {
     static constexpr size_t value = N;
 };
 
+// Param 6 is optional, defaults to the split layout
+template<class TestDescriptor, bool = (std::tuple_size<TestDescriptor>::value > 6)>
+struct LayoutOf {
+    using type = estd::SplitLayoutPolicy;
+};
+
+template<class TestDescriptor>
+struct LayoutOf<TestDescriptor, true> {
+    using type = std::tuple_element_t<6, TestDescriptor>;
+};
+
 // Param 0 - storage size
 // Param 1 - alignment size
 // Param 2 - PropOnCCopy 
 // Param 3 - PropOnCMove 
 // Param 4 - PropOnCSwap 
 // Param 5 - initial alloc size
+// Param 6 - LayoutPolicy (optional)
 
 // Test Desciptor is a Tuple of the params above
 template<class TestDescriptor>
@@ -63,13 +77,15 @@ public:
     using PropOnCSwap = std::decay_t<decltype(std::get<4>(std::declval<TestDescriptor>()))>;
     static constexpr size_t alloc_size = std::decay_t<decltype(std::get<5>(std::declval<TestDescriptor>()))>::value;
     using Allocator = Mock::AllocatorMock<uint8_t, PropOnCCopy, PropOnCMove, PropOnCSwap>;
+    using LayoutPolicy = typename LayoutOf<TestDescriptor>::type;
     static constexpr uintptr_t ptr = 0xc0dedead;
 
     using storage_t = 
         estd::sso_storage_t<
             storage_size, 
             alignment, 
-            Allocator
+            Allocator,
+            LayoutPolicy
         >;
 
     //TestNew() : s(init_alloc_size) {}
@@ -704,6 +720,48 @@ REGISTER_TYPED_TEST_CASE_P(TestInlineAllocation,
 
 /////////////////////////////////////////////
 
+template<class LayoutPolicy>
+using layout_test_t = estd::sso_storage_t<
+    def_storage_size,
+    alignof(void*),
+    std::allocator<uint8_t>,
+    LayoutPolicy>;
+
+TEST(ObjStorageLayoutTest, union_layout_overlays_heap_pointer_on_inline_storage) {
+    using split_t = layout_test_t<estd::SplitLayoutPolicy>;
+    using union_t = layout_test_t<estd::UnionLayoutPolicy>;
+    EXPECT_EQ(split_t::max_size(), union_t::max_size());
+    EXPECT_EQ(union_t::max_size() + sizeof(size_t), sizeof(union_t));
+    EXPECT_EQ(sizeof(split_t) - sizeof(void*), sizeof(union_t));
+}
+
+TEST(ObjStorageLayoutTest, union_layout_construction_does_not_touch_inline_storage) {
+    using union_t = layout_test_t<estd::UnionLayoutPolicy>;
+    constexpr uint8_t pattern = 0xa5;
+    EXPECT_TRUE(std::is_nothrow_default_constructible<union_t>::value);
+
+    alignas(union_t) uint8_t buffer[sizeof(union_t)];
+    std::fill(std::begin(buffer), std::end(buffer), pattern);
+    auto s = ::new (buffer) union_t;
+    EXPECT_EQ(nullptr, s->get());
+
+    auto p = static_cast<uint8_t*>(s->allocate(union_t::max_size()));
+    EXPECT_TRUE(std::all_of(p, p + union_t::max_size(),
+        [=](uint8_t b) { return b == pattern; }));
+    s->~union_t();
+}
+
+TEST(ObjStorageLayoutTest, union_layout_get_returns_nullptr_after_deallocation) {
+    using union_t = layout_test_t<estd::UnionLayoutPolicy>;
+    union_t s1{ union_t::max_size() }, s2{ union_t::max_size() + 1 };
+    EXPECT_NE(nullptr, s1.get());
+    EXPECT_NE(nullptr, s2.get());
+    s1.deallocate();
+    s2.deallocate();
+    EXPECT_EQ(nullptr, s1.get());
+    EXPECT_EQ(nullptr, s2.get());
+}
+
 TEST_P(AllocationTest, CopyConstruction) {
 
     estd::sso_storage s2 = s;
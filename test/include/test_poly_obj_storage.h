@@ -87,6 +87,69 @@ namespace PolyStorageTest {
         double t[16];
     };
 
+    // counts the virtual moves, opted in to bytewise relocation
+    struct RelocatableImpl : public IF {
+        RelocatableImpl() = default;
+        RelocatableImpl(const RelocatableImpl& rhs) {
+            my_index = rhs.my_index;
+        }
+
+        RelocatableImpl(RelocatableImpl&& rhs) {
+            my_index = rhs.my_index;
+            rhs.my_index = moved_from_indicator;
+        }
+
+        virtual ret_code_t func() override {
+            return from_impl1;
+        }
+        virtual IF* clone(void*d)const override {
+            return new (d) RelocatableImpl(*this);
+        }
+        virtual IF* move(void*d) noexcept override {
+            ++moves;
+            return new (d) RelocatableImpl(std::move(*this));
+        }
+
+        static int moves;
+    };
+
+    struct LargeRelocatableImpl : public RelocatableImpl {
+        virtual IF* move(void*d) noexcept override {
+            ++moves;
+            return new (d) LargeRelocatableImpl(std::move(*this));
+        }
+
+        double t[16];
+    };
+
+    // object of exactly N bytes
+    template<size_t N>
+    struct SizedImpl : public Impl1 {
+        virtual IF* clone(void*d)const override {
+            return new (d) SizedImpl(*this);
+        }
+        virtual IF* move(void*d) noexcept override {
+            return new (d) SizedImpl(std::move(*this));
+        }
+
+        uint8_t payload[N - sizeof(Impl1)];
+    };
+
+    // byte allocator whose instances never compare equal and that
+    // does not propagate on move assignment
+    struct UnequalAllocator : public std::allocator<uint8_t> {
+        template<typename T>
+        struct rebind {
+            using other = UnequalAllocator;
+        };
+        using propagate_on_container_move_assignment = std::false_type;
+        using is_always_equal = std::false_type;
+
+        bool operator==(const UnequalAllocator&) const noexcept {
+            return false;
+        }
+    };
+
     class PolyStorageBasicTest : public ::testing::Test {
     public:
         PolyStorageBasicTest() : s1(Impl1{}), s2(Impl2{}) {}
@@ -96,4 +159,16 @@ namespace PolyStorageTest {
 
 }  // namespace PolyStorageTest
 
+namespace estd {
+template<>
+struct is_trivially_relocatable<PolyStorageTest::RelocatableImpl> :
+    public ::std::true_type {
+};
+
+template<>
+struct is_trivially_relocatable<PolyStorageTest::LargeRelocatableImpl> :
+    public ::std::true_type {
+};
+}  // namespace estd
+
 #endif  // TEST_POLY_OBJ_STORAGE_H_
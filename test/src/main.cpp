@@ -35,10 +35,14 @@
 int PullInTestObjStorageLibrary();
 int PullInTestPolyObjStorageLibrary();
 int PullInTestMemResourceLibrary();
+int PullInTestSmallVectorLibrary();
+int PullInTestFunctionalLibrary();
 
 static int dummyObjStorage = PullInTestObjStorageLibrary();
 static int dummyPolyObjStorage = PullInTestPolyObjStorageLibrary();
 static int dummyMemResource = PullInTestMemResourceLibrary();
+static int dummySmallVector = PullInTestSmallVectorLibrary();
+static int dummyFunctional = PullInTestFunctionalLibrary();
 
 extern int func();
 
@@ -0,0 +1,402 @@
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "functional.h"
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#ifdef _MSC_VER
+__declspec(dllexport)
+#endif  // _MSC_VER
+int PullInTestFunctionalLibrary() { return 0; }
+
+namespace FunctionalTest {
+
+// callable with a large capture that counts its constructions
+struct Counted {
+    Counted(int v) : value { v }
+    {
+        ++constructions;
+    }
+
+    Counted(const Counted& c) : value { c.value }, payload(c.payload)
+    {
+        ++copies;
+    }
+
+    Counted(Counted&& c) : value { c.value }, payload(c.payload)
+    {
+        ++moves;
+    }
+
+    int operator()(int i)
+    {
+        return value + i;
+    }
+
+    static void reset()
+    {
+        constructions = copies = moves = 0;
+    }
+
+    int value;
+    std::array<double, 16> payload{};
+
+    static int constructions;
+    static int copies;
+    static int moves;
+};
+
+int Counted::constructions { 0 };
+int Counted::copies { 0 };
+int Counted::moves { 0 };
+
+using if_t = estd::interface<int(int)>;
+
+// byte allocator counting the allocations of all instances
+struct CountingAllocator : public std::allocator<uint8_t> {
+    template<typename T>
+    struct rebind {
+        using other = CountingAllocator;
+    };
+
+    uint8_t* allocate(size_t n)
+    {
+        ++allocations;
+        return std::allocator<uint8_t>::allocate(n);
+    }
+
+    static int allocations;
+};
+
+int CountingAllocator::allocations { 0 };
+
+TEST(InterfaceTest, BindingCallableMovesItIntoTheStorage) {
+    Counted::reset();
+    if_t i{ Counted{ 1 } };
+    EXPECT_EQ(3, i(2));
+    EXPECT_EQ(1, Counted::constructions);
+    EXPECT_EQ(0, Counted::copies);
+    EXPECT_EQ(1, Counted::moves);
+}
+
+TEST(InterfaceTest, InPlaceConstructionDoesNotMoveOrCopy) {
+    Counted::reset();
+    if_t i{ estd::in_place_type<Counted>, 1 };
+    EXPECT_EQ(3, i(2));
+    EXPECT_EQ(1, Counted::constructions);
+    EXPECT_EQ(0, Counted::copies);
+    EXPECT_EQ(0, Counted::moves);
+}
+
+TEST(InterfaceTest, InPlaceConstructionWithAllocator) {
+    Counted::reset();
+    if_t i{ std::allocator_arg, std::allocator<uint8_t>{},
+        estd::in_place_type<Counted>, 5 };
+    EXPECT_EQ(7, i(2));
+    EXPECT_EQ(1, Counted::constructions);
+    EXPECT_EQ(0, Counted::moves);
+}
+
+TEST(InterfaceTest, EmplaceRebindsInPlace) {
+    if_t i;
+    EXPECT_THROW(i(1), std::bad_function_call);
+    Counted::reset();
+    i.emplace<Counted>(10);
+    EXPECT_EQ(11, i(1));
+    i.emplace<Counted>(20);
+    EXPECT_EQ(21, i(1));
+    EXPECT_EQ(2, Counted::constructions);
+    EXPECT_EQ(0, Counted::copies);
+    EXPECT_EQ(0, Counted::moves);
+    auto l = [](int x) { return -x; };
+    i.emplace<decltype(l)>(l);
+    EXPECT_EQ(-1, i(1));
+}
+
+TEST(InterfaceTest, DefaultsAreUnchanged) {
+    EXPECT_EQ(4U, if_t::max_storage_size);
+    EXPECT_TRUE((std::is_same<if_t, estd::basic_interface_t<4,
+        alignof(std::max_align_t), std::allocator<uint8_t>, int(int)>>::value));
+    EXPECT_TRUE((std::is_same<estd::function<int(int)>, if_t>::value));
+}
+
+TEST(InterfaceTest, CustomInlineSizeAvoidsAllocation) {
+    std::array<int, 10> capture{ { 1 } };
+    auto l = [capture](int i) { return capture[0] + i; };
+    using default_if = estd::interface_t<CountingAllocator, int(int)>;
+    using large_if = estd::basic_interface_t<8, alignof(void*), CountingAllocator, int(int)>;
+    CountingAllocator::allocations = 0;
+    default_if i1{ l };
+    EXPECT_EQ(1, CountingAllocator::allocations);
+    large_if i2{ l };
+    EXPECT_EQ(1, CountingAllocator::allocations);
+    EXPECT_EQ(2, i1(1));
+    EXPECT_EQ(2, i2(1));
+}
+
+TEST(InterfaceTest, FittedInterfaceHoldsAllImplementationsInline) {
+    auto small = [](int i) { return i; };
+    std::array<char, 44> capture{ { 2 } };
+    auto large = [capture](int i) { return capture[0] * i; };
+    using fitted_if = if_t::fitted_for<decltype(small), decltype(large)>;
+    EXPECT_EQ(7U, fitted_if::max_storage_size);
+    using counting_if = estd::interface_t<CountingAllocator, int(int)>::
+        fitted_for<decltype(small), decltype(large)>;
+    CountingAllocator::allocations = 0;
+    counting_if i1{ small }, i2{ large };
+    EXPECT_EQ(0, CountingAllocator::allocations);
+    EXPECT_EQ(3, i1(3));
+    EXPECT_EQ(6, i2(3));
+    using tiny_if = if_t::fitted_for<decltype(small)>;
+    EXPECT_LT(sizeof(tiny_if), sizeof(if_t));
+    tiny_if i3{ estd::in_place_type<decltype(small)>, small };
+    EXPECT_EQ(1, i3(1));
+}
+
+using unique_if = estd::unique_interface<int(int), void(std::vector<int>&)>;
+
+// move only callable with two signatures
+struct MoveOnly {
+    explicit MoveOnly(int v) : value { new int(v) }
+    {
+    }
+
+    int operator()(int i)
+    {
+        return *value + i;
+    }
+
+    void operator()(std::vector<int>& v)
+    {
+        v.push_back(*value);
+    }
+
+    std::unique_ptr<int> value;
+};
+
+TEST(UniqueInterfaceTest, IsMoveOnly) {
+    EXPECT_FALSE(std::is_copy_constructible<unique_if>::value);
+    EXPECT_FALSE(std::is_copy_assignable<unique_if>::value);
+    EXPECT_TRUE(std::is_nothrow_move_constructible<unique_if>::value);
+    EXPECT_TRUE(std::is_nothrow_move_assignable<unique_if>::value);
+}
+
+TEST(UniqueInterfaceTest, HoldsMoveOnlyCallables) {
+    auto p = std::make_unique<int>(3);
+    unique_if i1{ [p = std::move(p)](auto&& a) { return *p + sizeof(a); } };
+    unique_if i2{ MoveOnly{ 5 } };
+    EXPECT_EQ(6, i2(1));
+    std::vector<int> v;
+    i2(v);
+    EXPECT_EQ(std::vector<int>{ 5 }, v);
+    unique_if i3{ std::move(i2) };
+    EXPECT_EQ(7, i3(2));
+    i2 = std::move(i3);
+    EXPECT_EQ(8, i2(3));
+}
+
+TEST(UniqueInterfaceTest, HeapStoredCallablesAreMoved) {
+    std::array<double, 16> payload{};
+    auto p = std::make_unique<int>(1);
+    estd::unique_interface<int(int)> i1{
+        [p = std::move(p), payload](int i) { return *p + i + static_cast<int>(payload[0]); } };
+    estd::unique_interface<int(int)> i2{ std::move(i1) };
+    EXPECT_EQ(2, i2(1));
+    std::vector<estd::unique_interface<int(int)>> v;
+    for (int i = 0; i < 10; ++i) {
+        v.emplace_back(estd::in_place_type<MoveOnly>, i);
+    }
+    v.emplace_back(std::move(i2));
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(i + 1, v[i](1));
+    }
+    EXPECT_EQ(2, v.back()(1));
+}
+
+TEST(UniqueInterfaceTest, EmplaceRebinds) {
+    estd::unique_interface<int(int)> i;
+    i.emplace<MoveOnly>(4);
+    EXPECT_EQ(5, i(1));
+    i.emplace<MoveOnly>(6);
+    EXPECT_EQ(7, i(1));
+}
+
+int call_with_ref(estd::interface_ref<int(int)> f, int i)
+{
+    return f(i);
+}
+
+TEST(InterfaceRefTest, IsTwoPointersAndTriviallyCopyable) {
+    using ref_t = estd::interface_ref<int(int), void(std::vector<int>&)>;
+    EXPECT_EQ(2 * sizeof(void*), sizeof(ref_t));
+    EXPECT_TRUE(std::is_trivially_copyable<ref_t>::value);
+}
+
+TEST(InterfaceRefTest, CallsReferredObjectWithoutCopying) {
+    Counted::reset();
+    Counted c{ 1 };
+    estd::interface_ref<int(int)> r{ c };
+    EXPECT_EQ(3, r(2));
+    c.value = 10;
+    EXPECT_EQ(12, r(2));
+    EXPECT_EQ(0, Counted::copies);
+    EXPECT_EQ(0, Counted::moves);
+}
+
+TEST(InterfaceRefTest, ResolvesOverloadsLikeInterface) {
+    MoveOnly m{ 3 };
+    estd::interface_ref<int(int), void(std::vector<int>&)> r{ m };
+    std::vector<int> v;
+    r(v);
+    EXPECT_EQ(4, r(1));
+    EXPECT_EQ(std::vector<int>{ 3 }, v);
+}
+
+TEST(InterfaceRefTest, BindsTemporariesConstObjectsAndInterfaces) {
+    EXPECT_EQ(4, call_with_ref([](int i) { return i * 2; }, 2));
+    const auto l = [](int i) { return i + 1; };
+    EXPECT_EQ(2, call_with_ref(l, 1));
+    if_t i{ l };
+    EXPECT_EQ(3, call_with_ref(i, 2));
+    estd::interface_ref<int(int)> r{ l };
+    r = estd::interface_ref<int(int)>{ i };
+    EXPECT_EQ(5, r(4));
+}
+
+using table_if = estd::table_interface<int(int), void(std::vector<int>&)>;
+
+// copyable callable with two signatures
+struct Accumulator {
+    int operator()(int i)
+    {
+        return sum += i;
+    }
+
+    void operator()(std::vector<int>& v)
+    {
+        v.push_back(sum);
+    }
+
+    int sum;
+};
+
+// stored on the heap by the default table_interface
+struct LargeAccumulator : public Accumulator {
+    explicit LargeAccumulator(int s) : Accumulator{ s }, payload{}
+    {
+    }
+
+    std::array<double, 16> payload;
+};
+
+TEST(TableInterfaceTest, UnboundThrowsBadFunctionCall) {
+    table_if i;
+    EXPECT_FALSE(i);
+    EXPECT_THROW(i(1), std::bad_function_call);
+    std::vector<int> v;
+    EXPECT_THROW(i(v), std::bad_function_call);
+}
+
+TEST(TableInterfaceTest, StoresCallableWithoutVptr) {
+    using tiny_if = table_if::fitted_for<Accumulator>;
+    EXPECT_EQ(1U, tiny_if::max_storage_size);
+    using tiny_virtual_if = estd::interface<int(int), void(std::vector<int>&)>::
+        fitted_for<Accumulator>;
+    EXPECT_LT(tiny_if::max_storage_size, tiny_virtual_if::max_storage_size);
+    tiny_if i{ Accumulator{ 1 } };
+    EXPECT_TRUE(i);
+    EXPECT_EQ(3, i(2));
+    std::vector<int> v;
+    i(v);
+    EXPECT_EQ(std::vector<int>{ 3 }, v);
+}
+
+TEST(TableInterfaceTest, CopyAndMove) {
+    for (auto large : { false, true }) {
+        table_if i1 = large ?
+            table_if{ LargeAccumulator{ 1 } } :
+            table_if{ Accumulator{ 1 } };
+        table_if i2{ i1 };
+        EXPECT_EQ(2, i1(1));
+        EXPECT_EQ(2, i2(1));
+        table_if i3{ std::move(i1) };
+        EXPECT_FALSE(i1);
+        EXPECT_TRUE(i3);
+        i1 = i3;
+        EXPECT_EQ(3, i3(1));
+        EXPECT_EQ(3, i1(1));
+        i2 = std::move(i3);
+        EXPECT_FALSE(i3);
+        EXPECT_THROW(i3(1), std::bad_function_call);
+        using std::swap;
+        swap(i2, i3);
+        EXPECT_FALSE(i2);
+        EXPECT_TRUE(i3);
+    }
+}
+
+TEST(TableInterfaceTest, HeapStoredCallablesAreTakenOverOnMove) {
+    Counted::reset();
+    {
+        estd::table_interface<int(int)> i1{ estd::in_place_type<Counted>, 1 };
+        estd::table_interface<int(int)> i2{ std::move(i1) };
+        EXPECT_EQ(3, i2(2));
+        auto i3 = i2;
+        EXPECT_EQ(3, i3(2));
+        i3.emplace<Counted>(5);
+        EXPECT_EQ(7, i3(2));
+    }
+    EXPECT_EQ(2, Counted::constructions);
+    EXPECT_EQ(1, Counted::copies);
+    EXPECT_EQ(0, Counted::moves);
+}
+
+TEST(TableInterfaceTest, InlineCallablesAreMovedIfNotTriviallyRelocatable) {
+    auto l = [s = std::string(64, 'a')](int i) { return i + static_cast<int>(s.size()); };
+    estd::table_interface<int(int)> i1{ l };
+    estd::table_interface<int(int)> i2{ std::move(i1) };
+    EXPECT_EQ(65, i2(1));
+    i1 = std::move(i2);
+    EXPECT_EQ(65, i1(1));
+}
+
+// callable of exactly N bytes adding its last byte
+template<size_t N>
+struct SizedCallable {
+    explicit SizedCallable(uint8_t v) : payload{}
+    {
+        payload.back() = v;
+    }
+
+    int operator()(int i)
+    {
+        return i + payload.back();
+    }
+
+    std::array<uint8_t, N> payload;
+};
+
+TEST(TableInterfaceTest, EmplaceReallocatesIfPaddedHeapBlockIsTooSmall) {
+    // heap sizes of the padded allocation include the 64 bytes of alignment
+    using padded_if = estd::basic_table_interface_t<4, 64, CountingAllocator, int(int)>;
+    padded_if i{ estd::in_place_type<SizedCallable<48>>, uint8_t{ 1 } };
+    EXPECT_EQ(2, i(1));
+    auto allocations = CountingAllocator::allocations;
+    i.emplace<SizedCallable<112>>(uint8_t{ 2 });
+    EXPECT_EQ(3, i(1));
+    EXPECT_EQ(allocations + 1, CountingAllocator::allocations);
+    i.emplace<SizedCallable<64>>(uint8_t{ 3 });
+    EXPECT_EQ(4, i(1));
+    EXPECT_EQ(allocations + 1, CountingAllocator::allocations);
+    i.emplace<SizedCallable<8>>(uint8_t{ 4 });
+    EXPECT_EQ(5, i(1));
+    i.emplace<SizedCallable<112>>(uint8_t{ 5 });
+    EXPECT_EQ(6, i(1));
+    EXPECT_EQ(allocations + 2, CountingAllocator::allocations);
+}
+
+}  // namespace FunctionalTest
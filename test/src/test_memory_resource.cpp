@@ -1,7 +1,21 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <set>
+#include <thread>
 #include <tuple>
+#include <vector>
 
 #include "memory.h"
+#include "memory_resource.h"
+#include "functional.h"
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 
@@ -17,5 +31,1102 @@ namespace MemResourceTest {
         EXPECT_EQ(nullptr, m.ptr());
     }
 
+    // upstream poly allocator counting the outstanding blocks
+    struct counting_upstream : public poly_alloc_impl<std::allocator<uint8_t>> {
+        void* allocate(size_t n, const void* hint = nullptr) override {
+            ++allocations;
+            bytes += n;
+            return poly_alloc_impl<std::allocator<uint8_t>>::allocate(n, hint);
+        }
 
-}  // namespace MemResourceTest 
\ No newline at end of file
+        void deallocate(void* p, size_t n) noexcept override {
+            --allocations;
+            bytes -= n;
+            poly_alloc_impl<std::allocator<uint8_t>>::deallocate(p, n);
+        }
+
+        void* allocate_aligned(size_t n, size_t alignment) override {
+            if (alignment <= alignof(std::max_align_t)) {
+                return allocate(n);
+            }
+            ++allocations;
+            bytes += n;
+            return poly_alloc_impl<std::allocator<uint8_t>>::allocate_aligned(n, alignment);
+        }
+
+        void deallocate_aligned(void* p, size_t n, size_t alignment) noexcept override {
+            if (alignment <= alignof(std::max_align_t)) {
+                return deallocate(p, n);
+            }
+            --allocations;
+            bytes -= n;
+            poly_alloc_impl<std::allocator<uint8_t>>::deallocate_aligned(p, n, alignment);
+        }
+
+        void allocate_bulk(size_t n, size_t count, void** out) override {
+            ++bulk_allocations;
+            poly_alloc_impl<std::allocator<uint8_t>>::allocate_bulk(n, count, out);
+        }
+
+        void deallocate_bulk(void* const* p, size_t count, size_t n) noexcept override {
+            ++bulk_deallocations;
+            poly_alloc_impl<std::allocator<uint8_t>>::deallocate_bulk(p, count, n);
+        }
+
+        int bulk_allocations = 0;
+        int bulk_deallocations = 0;
+        int allocations = 0;
+        size_t bytes = 0;
+    };
+
+    // stateful byte allocator, copies are equal
+    struct stateful_allocator : std::allocator<uint8_t> {
+        using is_always_equal = std::false_type;
+        template<typename T>
+        struct rebind {
+            using other = std::allocator<T>;
+        };
+    };
+
+    TEST(poly_alloc_t_test, identity_of_poly_alloc_impl) {
+        poly_alloc_impl<std::allocator<uint8_t>> a1, a2;
+        EXPECT_EQ(a1, a2);
+        EXPECT_EQ(default_poly_allocator::instance(), a1);
+        poly_alloc_impl<stateful_allocator> s1, s2;
+        EXPECT_NE(s1, s2);
+        EXPECT_NE(a1, s1);
+        auto s3 = s1;
+        EXPECT_EQ(s1, s3);
+        std::unique_ptr<poly_alloc_t, poly_deleter> clone{
+            s1.clone(a1), poly_deleter::from(poly_alloc_wrapper<poly_alloc_impl<stateful_allocator>>(a1)) };
+        EXPECT_EQ(s1, *clone);
+        EXPECT_EQ(poly_alloc_wrapper<int>(s1), poly_alloc_wrapper<double>(*clone));
+    }
+
+    TEST(poly_alloc_t_test, identity_of_resources) {
+        monotonic_arena_t arena1, arena2;
+        EXPECT_EQ(arena1, arena1);
+        EXPECT_NE(arena1, arena2);
+        EXPECT_NE(default_poly_allocator::instance(), arena1);
+        poly_alloc_impl<std::allocator<uint8_t>> a;
+        std::unique_ptr<poly_alloc_t, poly_deleter> ref{
+            arena1.clone(a), poly_deleter::from(poly_alloc_wrapper<impl::poly_resource_ref<monotonic_arena_t>>(a)) };
+        EXPECT_EQ(arena1, *ref);
+        EXPECT_EQ(*ref, arena1);
+        EXPECT_NE(arena2, *ref);
+    }
+
+    bool within(const void* p, const void* begin, size_t n) {
+        auto a = reinterpret_cast<uintptr_t>(p);
+        auto b = reinterpret_cast<uintptr_t>(begin);
+        return a >= b && a < b + n;
+    }
+
+    TEST(monotonic_arena_t_test, allocates_from_initial_block_with_alignment) {
+        alignas(64) uint8_t buffer[256];
+        monotonic_arena_t arena{ memory_resource_t{ buffer, sizeof(buffer) } };
+        auto p1 = arena.allocate(1, 1);
+        auto p2 = arena.allocate(8, 8);
+        auto p3 = arena.allocate(16, 64);
+        EXPECT_EQ(buffer, p1);
+        EXPECT_EQ(buffer + 8, p2);
+        EXPECT_EQ(buffer + 64, p3);
+        EXPECT_EQ(sizeof(buffer) - 80, arena.remaining());
+    }
+
+    TEST(monotonic_arena_t_test, throws_bad_alloc_without_upstream) {
+        uint8_t buffer[64];
+        monotonic_arena_t arena{ memory_resource_t{ buffer, sizeof(buffer) } };
+        arena.allocate(60, 1);
+        EXPECT_THROW(arena.allocate(8, 1), std::bad_alloc);
+    }
+
+    TEST(monotonic_arena_t_test, rejects_sizes_overflowing_the_block_size) {
+        counting_upstream upstream;
+        monotonic_arena_t arena{ upstream };
+        auto huge = std::numeric_limits<size_t>::max() - 8;
+        EXPECT_THROW(arena.allocate(huge, 16), std::bad_alloc);
+        EXPECT_THROW(arena.allocate(upstream.max_size(), 1), std::bad_alloc);
+        EXPECT_EQ(0, upstream.allocations);
+    }
+
+    TEST(monotonic_arena_t_test, grows_from_upstream_and_release_returns_blocks) {
+        counting_upstream upstream;
+        uint8_t buffer[64];
+        {
+            monotonic_arena_t arena{ memory_resource_t{ buffer, sizeof(buffer) }, upstream, 128 };
+            EXPECT_TRUE(within(arena.allocate(64, 1), buffer, sizeof(buffer)));
+            EXPECT_EQ(0, upstream.allocations);
+            arena.allocate(64, 8);
+            EXPECT_EQ(1, upstream.allocations);
+            arena.allocate(64, 8);
+            EXPECT_EQ(2, upstream.allocations);
+            // larger than the next block
+            arena.allocate(4096, 8);
+            EXPECT_EQ(3, upstream.allocations);
+            arena.release();
+            EXPECT_EQ(0, upstream.allocations);
+            EXPECT_EQ(buffer, arena.allocate(8, 8));
+            arena.allocate(128, 8);
+            EXPECT_EQ(1, upstream.allocations);
+        }
+        EXPECT_EQ(0, upstream.allocations);
+        EXPECT_EQ(0U, upstream.bytes);
+    }
+
+    TEST(monotonic_arena_t_test, block_size_grows_geometrically) {
+        counting_upstream upstream;
+        monotonic_arena_t arena{ upstream, 256 };
+        for (int i = 0; i < 64; ++i) {
+            arena.allocate(64, 8);
+        }
+        // 4096 bytes + headers need 256 + 512 + 1024 + 2048 + 4096 byte blocks
+        EXPECT_EQ(5, upstream.allocations);
+    }
+
+    TEST(monotonic_arena_t_test, byte_allocator_for_sso_storage) {
+        uint8_t buffer[1024];
+        monotonic_arena_t arena{ memory_resource_t{ buffer, sizeof(buffer) } };
+        using storage_t = sso_storage_t<4, alignof(std::max_align_t),
+            monotonic_arena_t::allocator<uint8_t>>;
+        EXPECT_TRUE((std::is_same<impl::AllocatorAlignedHeapAllocation,
+            storage_t::heap_allocation>::value));
+        storage_t s{ std::allocator_arg, arena.get_allocator() };
+        s.allocate(100);
+        EXPECT_TRUE(within(s.get(), buffer, sizeof(buffer)));
+        EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(s.get()) % alignof(std::max_align_t));
+    }
+
+    TEST(monotonic_arena_t_test, allocator_for_interface_and_containers) {
+        uint8_t buffer[2048];
+        monotonic_arena_t arena{ memory_resource_t{ buffer, sizeof(buffer) } };
+        std::array<double, 16> capture{ { 1.0 } };
+        interface_t<monotonic_arena_t::allocator<uint8_t>, double()> i{
+            std::allocator_arg, arena.get_allocator(), [capture]() { return capture[0]; } };
+        EXPECT_EQ(1.0, i());
+        EXPECT_LT(arena.remaining(), sizeof(buffer) - sizeof(capture));
+        std::vector<int, monotonic_arena_t::allocator<int>> v(arena.get_allocator<int>());
+        v.assign(10, 1);
+        EXPECT_TRUE(within(v.data(), buffer, sizeof(buffer)));
+    }
+
+    TEST(monotonic_arena_t_test, poly_alloc_implementation) {
+        uint8_t buffer[1024];
+        monotonic_arena_t arena{ memory_resource_t{ buffer, sizeof(buffer) } };
+        poly_alloc_t& pa = arena;
+        std::vector<int, poly_alloc_wrapper<int>> v{ poly_alloc_wrapper<int>(pa) };
+        v.assign(10, 1);
+        EXPECT_TRUE(within(v.data(), buffer, sizeof(buffer)));
+        auto clone = arena.clone(default_poly_allocator::instance());
+        EXPECT_TRUE(within(clone->allocate(8), buffer, sizeof(buffer)));
+        EXPECT_TRUE(*clone == arena);
+        clone->~poly_alloc_t();
+        default_poly_allocator::instance().deallocate(clone,
+            sizeof(impl::poly_resource_ref<monotonic_arena_t>));
+    }
+
+    TEST(arena_scope_test, rollback_frees_scope_allocations) {
+        counting_upstream upstream;
+        uint8_t buffer[128];
+        monotonic_arena_t arena{ memory_resource_t{ buffer, sizeof(buffer) }, upstream, 256 };
+        arena.allocate(32, 8);
+        auto remaining = arena.remaining();
+        {
+            arena_scope outer{ arena };
+            outer.allocate(64, 8);
+            {
+                arena_scope inner{ arena };
+                inner.allocate(512, 8);
+                EXPECT_EQ(1, upstream.allocations);
+            }
+            // the block is kept as spare for the next scope
+            EXPECT_EQ(1, upstream.allocations);
+            EXPECT_EQ(remaining - 64, arena.remaining());
+            arena_scope inner{ arena };
+            inner.allocate(512, 8);
+            EXPECT_EQ(1, upstream.allocations);
+        }
+        EXPECT_EQ(remaining, arena.remaining());
+        EXPECT_EQ(buffer + 32, arena.allocate(8, 8));
+        arena.release();
+        EXPECT_EQ(0, upstream.allocations);
+    }
+
+    TEST(arena_scope_test, checkpoint_and_rollback) {
+        uint8_t buffer[128];
+        monotonic_arena_t arena{ memory_resource_t{ buffer, sizeof(buffer) } };
+        auto mark = arena.checkpoint();
+        arena.allocate(100, 1);
+        EXPECT_THROW(arena.allocate(100, 1), std::bad_alloc);
+        arena.rollback(mark);
+        EXPECT_EQ(buffer, arena.allocate(100, 1));
+    }
+
+    TEST(arena_scope_test, interfaces_allocate_in_the_scope) {
+        uint8_t buffer[1024];
+        monotonic_arena_t arena{ memory_resource_t{ buffer, sizeof(buffer) } };
+        std::array<double, 16> capture{ { 2.0 } };
+        using poly_if = interface_t<poly_alloc_wrapper<uint8_t>, double()>;
+        for (int i = 0; i < 100; ++i) {
+            arena_scope scope{ arena };
+            poly_if f{ std::allocator_arg, poly_alloc_wrapper<uint8_t>(scope),
+                [capture]() { return capture[0]; } };
+            using scoped_if = interface_t<arena_scope::allocator<uint8_t>, double()>;
+            scoped_if g{ std::allocator_arg, scope.get_allocator(),
+                [capture]() { return capture[0]; } };
+            EXPECT_EQ(2.0, f());
+            EXPECT_EQ(2.0, g());
+            EXPECT_LT(scope.get_arena().remaining(), sizeof(buffer) - 2 * sizeof(capture));
+        }
+        EXPECT_EQ(sizeof(buffer), arena.remaining());
+    }
+
+    TEST(inline_arena_test, allocates_inline_then_from_upstream) {
+        counting_upstream upstream;
+        inline_arena<256> arena{ upstream };
+        auto p1 = arena.allocate(200, 8);
+        EXPECT_TRUE(arena.is_inline(p1));
+        EXPECT_TRUE(within(p1, &arena, sizeof(arena)));
+        EXPECT_EQ(0, upstream.allocations);
+        auto p2 = arena.allocate(100, 8);
+        EXPECT_FALSE(arena.is_inline(p2));
+        EXPECT_EQ(1, upstream.allocations);
+        arena.release();
+        EXPECT_EQ(0, upstream.allocations);
+        EXPECT_TRUE(arena.is_inline(arena.allocate(200, 8)));
+    }
+
+    TEST(inline_arena_test, backs_std_containers_and_sso_storage) {
+        counting_upstream upstream;
+        inline_arena<1024> arena{ upstream };
+        std::list<int, poly_alloc_wrapper<int>> l{ arena.get_poly_allocator<int>() };
+        for (int i = 0; i < 10; ++i) {
+            l.push_back(i);
+        }
+        EXPECT_TRUE(arena.is_inline(&l.back()));
+        std::vector<int, monotonic_arena_t::allocator<int>> v{ arena.get_allocator<int>() };
+        v.assign({ 1, 2, 3 });
+        EXPECT_TRUE(arena.is_inline(v.data()));
+        std::array<double, 16> capture{ { 5.0 } };
+        interface_t<monotonic_arena_t::allocator<uint8_t>, double()> f{
+            std::allocator_arg, arena.get_allocator(), [capture]() { return capture[0]; } };
+        EXPECT_EQ(5.0, f());
+        EXPECT_EQ(0, upstream.allocations);
+    }
+
+    TEST(slab_pool_t_test, blocks_of_a_size_class_are_reused) {
+        counting_upstream upstream;
+        slab_pool_t pool{ upstream };
+        auto p1 = pool.allocate(40, 8);
+        EXPECT_EQ(1, upstream.allocations);
+        pool.deallocate(p1, 40, 8);
+        // 33..48 bytes share a class
+        EXPECT_EQ(p1, pool.allocate(48, 8));
+        EXPECT_NE(p1, pool.allocate(40, 8));
+        EXPECT_EQ(1, upstream.allocations);
+    }
+
+    TEST(slab_pool_t_test, blocks_have_no_headers) {
+        slab_pool_t pool;
+        auto p1 = static_cast<uint8_t*>(pool.allocate(32, 16));
+        auto p2 = static_cast<uint8_t*>(pool.allocate(32, 16));
+        auto p3 = static_cast<uint8_t*>(pool.allocate(20, 16));
+        EXPECT_EQ(p1 + 32, p2);
+        EXPECT_EQ(p2 + 32, p3);
+        EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p1) % slab_pool_t::granularity);
+    }
+
+    TEST(slab_pool_t_test, large_and_overaligned_requests_go_to_upstream) {
+        counting_upstream upstream;
+        slab_pool_t pool{ upstream, 128 };
+        EXPECT_EQ(128U, pool.max_pooled_size());
+        auto p1 = pool.allocate(129, 8);
+        EXPECT_EQ(1, upstream.allocations);
+        auto p2 = pool.allocate(8, 64);
+        EXPECT_EQ(2, upstream.allocations);
+        EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p2) % 64);
+        pool.deallocate(p1, 129, 8);
+        pool.deallocate(p2, 8, 64);
+        EXPECT_EQ(0, upstream.allocations);
+        EXPECT_EQ(0U, upstream.bytes);
+    }
+
+    TEST(slab_pool_t_test, carves_slabs_from_initial_block) {
+        counting_upstream upstream;
+        alignas(16) uint8_t buffer[512];
+        slab_pool_t pool{ memory_resource_t{ buffer, sizeof(buffer) }, upstream, 256, 256 };
+        EXPECT_TRUE(within(pool.allocate(64, 16), buffer, sizeof(buffer)));
+        EXPECT_TRUE(within(pool.allocate(16, 16), buffer, sizeof(buffer)));
+        EXPECT_EQ(0, upstream.allocations);
+        pool.release();
+        EXPECT_TRUE(within(pool.allocate(64, 16), buffer, sizeof(buffer)));
+    }
+
+    TEST(slab_pool_t_test, byte_allocator_for_heap_spills) {
+        counting_upstream upstream;
+        slab_pool_t pool{ upstream };
+        using storage_t = sso_storage_t<4, alignof(std::max_align_t),
+            slab_pool_t::allocator<uint8_t>>;
+        auto spill = [&pool] {
+            storage_t s1{ std::allocator_arg, pool.get_allocator() };
+            storage_t s2{ std::allocator_arg, pool.get_allocator() };
+            s1.allocate(48);
+            s2.allocate(160);
+        };
+        spill();
+        auto warm = upstream.allocations;
+        for (int i = 0; i < 1000; ++i) {
+            spill();
+        }
+        EXPECT_EQ(warm, upstream.allocations);
+        std::array<double, 16> capture{ { 3.0 } };
+        interface_t<slab_pool_t::allocator<uint8_t>, double()> f{
+            std::allocator_arg, pool.get_allocator(), [capture]() { return capture[0]; } };
+        auto g = f;
+        EXPECT_EQ(3.0, g());
+        EXPECT_EQ(warm, upstream.allocations);
+    }
+
+    TEST(unsynchronized_pool_test, normalizes_options) {
+        unsynchronized_pool p1;
+        EXPECT_EQ(unsynchronized_pool::default_max_blocks_per_chunk, p1.options().max_blocks_per_chunk);
+        EXPECT_EQ(unsynchronized_pool::default_largest_required_pool_block,
+            p1.options().largest_required_pool_block);
+        EXPECT_EQ(&default_poly_allocator::instance(), p1.upstream_resource());
+        pool_options_t options;
+        options.largest_required_pool_block = 3000;
+        unsynchronized_pool p2{ default_poly_allocator::instance(), options };
+        EXPECT_EQ(4096U, p2.options().largest_required_pool_block);
+    }
+
+    TEST(unsynchronized_pool_test, chunks_grow_up_to_max_blocks_per_chunk) {
+        counting_upstream upstream;
+        pool_options_t options;
+        options.max_blocks_per_chunk = 64;
+        unsynchronized_pool pool{ upstream, options };
+        auto p1 = pool.allocate(20);
+        pool.deallocate(p1, 20);
+        EXPECT_EQ(p1, pool.allocate(32));
+        EXPECT_EQ(1, upstream.allocations);
+        // chunks of 16, 32, 64 and 64 blocks
+        for (int i = 1; i < 16 + 32 + 64 + 64; ++i) {
+            pool.allocate(32);
+        }
+        EXPECT_EQ(4, upstream.allocations);
+        pool.allocate(32);
+        EXPECT_EQ(5, upstream.allocations);
+    }
+
+    TEST(unsynchronized_pool_test, release_returns_chunks_and_large_blocks) {
+        counting_upstream upstream;
+        unsynchronized_pool pool{ upstream };
+        pool.allocate(100);
+        auto p1 = pool.allocate(5000);
+        auto p2 = pool.allocate(10, 256);
+        auto p3 = pool.allocate(6000);
+        EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p2) % 256);
+        EXPECT_EQ(4, upstream.allocations);
+        pool.deallocate(p1, 5000);
+        EXPECT_EQ(3, upstream.allocations);
+        std::memset(p3, 0, 6000);
+        pool.release();
+        EXPECT_EQ(0, upstream.allocations);
+        EXPECT_EQ(0U, upstream.bytes);
+        pool.allocate(100);
+        EXPECT_EQ(1, upstream.allocations);
+    }
+
+    TEST(unsynchronized_pool_test, pools_chain_through_upstream) {
+        counting_upstream upstream;
+        unsynchronized_pool system{ upstream };
+        {
+            pool_options_t options;
+            options.largest_required_pool_block = 256;
+            unsynchronized_pool subsystem{ system, options };
+            std::vector<int, unsynchronized_pool::allocator<int>> v{ subsystem.get_allocator<int>() };
+            for (int i = 0; i < 1000; ++i) {
+                v.push_back(i);
+            }
+            EXPECT_EQ(999, v.back());
+            v.clear();
+            v.shrink_to_fit();
+        }
+        auto outstanding = upstream.allocations;
+        {
+            unsynchronized_pool subsystem{ system, pool_options_t{ } };
+            subsystem.allocate(4000);
+        }
+        EXPECT_EQ(outstanding, upstream.allocations);
+    }
+
+    TEST(synchronized_pool_test, concurrent_allocations) {
+        counting_upstream upstream;
+        synchronized_pool pool{ upstream };
+        using vec_t = std::vector<int, synchronized_pool::allocator<int>>;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&pool, t] {
+                for (int i = 0; i < 500; ++i) {
+                    vec_t v{ pool.get_allocator<int>() };
+                    v.assign(static_cast<size_t>(i % 100) * 20, t);
+                    EXPECT_EQ(v.size(), static_cast<size_t>(std::count(v.begin(), v.end(), t)));
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        pool.release();
+        EXPECT_EQ(0, upstream.allocations);
+    }
+
+    // cache line padded counter, e.g. per core statistics
+    struct alignas(64) padded_counter {
+        uint64_t value;
+    };
+
+    TEST(poly_alloc_t_test, over_aligned_allocation_through_wrapper) {
+        counting_upstream counting;
+        poly_alloc_impl<stateful_allocator> padded;
+        for (poly_alloc_t* a : { &default_poly_allocator::instance(),
+                static_cast<poly_alloc_t*>(&counting), static_cast<poly_alloc_t*>(&padded) }) {
+            std::vector<padded_counter, poly_alloc_wrapper<padded_counter>> v(
+                5, padded_counter{ 1 }, poly_alloc_wrapper<padded_counter>(*a));
+            EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(v.data()) % 64);
+            auto p = a->allocate_aligned(100, 4096);
+            EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p) % 4096);
+            a->deallocate_aligned(p, 100, 4096);
+        }
+        EXPECT_EQ(0, counting.allocations);
+    }
+
+    TEST(poly_alloc_t_test, poly_deleter_frees_over_aligned_objects) {
+        counting_upstream upstream;
+        poly_alloc_wrapper<padded_counter> a(upstream);
+        std::unique_ptr<padded_counter, poly_deleter> p{
+            new(a.allocate(1)) padded_counter{ 42 }, poly_deleter::from(a) };
+        EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p.get()) % 64);
+        EXPECT_EQ(1, upstream.allocations);
+        p.reset();
+        EXPECT_EQ(0, upstream.allocations);
+    }
+
+    TEST(poly_alloc_t_test, resources_serve_aligned_requests_through_the_interface) {
+        monotonic_arena_t arena;
+        poly_alloc_t& a = arena;
+        // a literal 0 is a null hint, not an alignment
+        a.allocate(1, 0);
+        auto p = a.allocate_aligned(64, 256);
+        EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p) % 256);
+        counting_upstream upstream;
+        std::unique_ptr<poly_alloc_t, poly_deleter> ref{
+            arena.clone(upstream), poly_deleter::from(poly_alloc_wrapper<impl::poly_resource_ref<monotonic_arena_t>>(upstream)) };
+        p = ref->allocate_aligned(64, 512);
+        EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p) % 512);
+        ref->deallocate_aligned(p, 64, 512);
+    }
+
+    TEST(scoped_default_allocator_test, default_constructed_wrappers_use_the_scope) {
+        auto& global = default_poly_allocator::global();
+        EXPECT_EQ(&global, &default_poly_allocator::instance());
+        counting_upstream outer, inner;
+        {
+            scoped_default_allocator s1{ outer };
+            std::vector<int, poly_alloc_wrapper<int>> v1(10);
+            EXPECT_EQ(1, outer.allocations);
+            {
+                scoped_default_allocator s2{ inner };
+                std::vector<int, poly_alloc_wrapper<int>> v2(10);
+                EXPECT_EQ(1, inner.allocations);
+                EXPECT_EQ(&outer, &v1.get_allocator().allocator());
+                poly_alloc_t* other_thread = nullptr;
+                std::thread([&other_thread] {
+                    other_thread = &default_poly_allocator::instance();
+                }).join();
+                EXPECT_EQ(&global, other_thread);
+            }
+            EXPECT_EQ(&outer, &default_poly_allocator::instance());
+        }
+        EXPECT_EQ(&global, &default_poly_allocator::instance());
+        EXPECT_EQ(0, outer.allocations);
+        EXPECT_EQ(0, inner.allocations);
+    }
+
+    TEST(scoped_default_allocator_test, resources_default_to_the_global_upstream) {
+        counting_upstream scoped;
+        scoped_default_allocator s{ scoped };
+        unsynchronized_pool pool;
+        statistics_resource_t stats;
+        EXPECT_EQ(&default_poly_allocator::global(), pool.upstream_resource());
+        EXPECT_EQ(&default_poly_allocator::global(), stats.upstream_resource());
+        pool.deallocate(pool.allocate(64), 64);
+        EXPECT_EQ(0, scoped.allocations);
+        EXPECT_EQ(&scoped, &poly_alloc_wrapper<int>().allocator());
+    }
+
+    TEST(poly_alloc_t_test, bulk_allocation_is_all_or_nothing) {
+        counting_upstream upstream;
+        void* blocks[10];
+        upstream.allocate_bulk(24, 10, blocks);
+        EXPECT_EQ(10, upstream.allocations);
+        upstream.deallocate_bulk(blocks, 10, 24);
+        EXPECT_EQ(0, upstream.allocations);
+        std::vector<uint8_t> region(4096);
+        tlsf_t tlsf{ memory_resource_t{ region.data(), region.size() } };
+        auto initial = tlsf.free_size();
+        EXPECT_THROW(tlsf.allocate_bulk(1000, 10, blocks), std::bad_alloc);
+        EXPECT_EQ(initial, tlsf.free_size());
+    }
+
+    TEST(poly_alloc_t_test, bulk_allocation_from_resources) {
+        monotonic_arena_t arena;
+        void* blocks[8];
+        arena.allocate_bulk(20, 8, blocks);
+        for (int i = 1; i < 8; ++i) {
+            EXPECT_EQ(static_cast<uint8_t*>(blocks[i - 1]) + 32, blocks[i]);
+        }
+        counting_upstream upstream;
+        synchronized_pool pool{ upstream };
+        poly_alloc_t& ref = pool;
+        ref.allocate_bulk(64, 8, blocks);
+        EXPECT_EQ(8U, std::set<void*>(blocks, blocks + 8).size());
+        ref.deallocate_bulk(blocks, 8, 64);
+        void* again[8];
+        pool.allocate_bulk(64, 8, again);
+        EXPECT_EQ(std::set<void*>(blocks, blocks + 8), std::set<void*>(again, again + 8));
+        pool.deallocate_bulk(again, 8, 64);
+    }
+
+    TEST(node_pool_t_test, prefills_free_lists_in_bulk) {
+        counting_upstream upstream;
+        {
+            node_pool_t pool{ upstream, 50 };
+            std::list<int, node_pool_t::allocator<int>> l{ pool.get_allocator<int>() };
+            for (int i = 0; i < 1000; ++i) {
+                l.push_back(i);
+            }
+            // 50 nodes per batch, at most 32 blocks per allocate_bulk
+            EXPECT_EQ(40, upstream.bulk_allocations);
+            EXPECT_EQ(1000, upstream.allocations);
+            l.clear();
+            for (int i = 0; i < 1000; ++i) {
+                l.push_front(i);
+            }
+            EXPECT_EQ(40, upstream.bulk_allocations);
+            l.clear();
+        }
+        EXPECT_EQ(0, upstream.allocations);
+        EXPECT_EQ(32, upstream.bulk_deallocations);
+    }
+
+    TEST(thread_cache_t_test, refills_in_batches_and_reuses_blocks) {
+        counting_upstream upstream;
+        thread_cache_t cache{ upstream, 256, 8, 4 };
+        auto p1 = cache.allocate(24);
+        EXPECT_EQ(4, upstream.allocations);
+        EXPECT_EQ(4 * 32U, upstream.bytes);
+        cache.deallocate(p1, 24);
+        EXPECT_EQ(p1, cache.allocate(32));
+        EXPECT_EQ(4, upstream.allocations);
+        cache.deallocate(p1, 32);
+        cache.flush();
+        EXPECT_EQ(0, upstream.allocations);
+    }
+
+    TEST(thread_cache_t_test, flushes_a_batch_above_the_cache_limit) {
+        counting_upstream upstream;
+        thread_cache_t cache{ upstream, 256, 8, 4 };
+        std::vector<void*> blocks;
+        for (int i = 0; i < 20; ++i) {
+            blocks.push_back(cache.allocate(16));
+        }
+        for (auto p : blocks) {
+            cache.deallocate(p, 16);
+        }
+        EXPECT_LE(upstream.allocations, 8);
+        EXPECT_GT(upstream.allocations, 4);
+    }
+
+    TEST(thread_cache_t_test, large_and_overaligned_requests_go_to_upstream) {
+        counting_upstream upstream;
+        thread_cache_t cache{ upstream, 64 };
+        auto p1 = cache.allocate(65);
+        EXPECT_EQ(1, upstream.allocations);
+        auto p2 = cache.allocate(16, 128);
+        EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p2) % 128);
+        cache.deallocate(p1, 65);
+        cache.deallocate(p2, 16, 128);
+        EXPECT_EQ(0, upstream.allocations);
+    }
+
+    TEST(thread_cache_t_test, caches_are_flushed_on_thread_exit_and_destruction) {
+        counting_upstream upstream;
+        {
+            thread_cache_t cache{ upstream };
+            void* p = nullptr;
+            std::thread t1{ [&] { p = cache.allocate(100); } };
+            t1.join();
+            EXPECT_EQ(1, upstream.allocations);
+            // freed by another thread
+            cache.deallocate(p, 100);
+            std::thread t2{ [&] {
+                for (int i = 0; i < 100; ++i) {
+                    cache.deallocate(cache.allocate(48), 48);
+                }
+            } };
+            t2.join();
+            EXPECT_EQ(1, upstream.allocations);
+        }
+        EXPECT_EQ(0, upstream.allocations);
+    }
+
+    TEST(thread_cache_t_test, destroyed_while_a_bound_thread_exits) {
+        counting_upstream upstream;
+        for (int i = 0; i < 200; ++i) {
+            std::unique_ptr<thread_cache_t> cache{ new thread_cache_t{ upstream } };
+            // the exiting thread also unbinds from another owner
+            counting_upstream other_upstream;
+            thread_cache_t other{ other_upstream };
+            std::atomic<bool> used{ false };
+            std::thread t{ [&] {
+                cache->deallocate(cache->allocate(48), 48);
+                other.deallocate(other.allocate(48), 48);
+                used = true;
+                // varies the interleaving with the destruction
+                std::this_thread::sleep_for(std::chrono::microseconds(i % 50));
+            } };
+            while (!used) {
+                std::this_thread::yield();
+            }
+            cache.reset();
+            t.join();
+        }
+        EXPECT_EQ(0, upstream.allocations);
+    }
+
+    TEST(thread_cache_t_test, concurrent_allocation_from_a_shared_pool) {
+        slab_pool_t pool;
+        thread_cache_t cache{ pool };
+        using vec_t = std::vector<int, thread_cache_t::allocator<int>>;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&cache, t] {
+                for (int i = 0; i < 1000; ++i) {
+                    vec_t v{ cache.get_allocator<int>() };
+                    for (int j = 0; j < i % 40; ++j) {
+                        v.push_back(t);
+                    }
+                    EXPECT_EQ(static_cast<size_t>(i % 40), std::count(v.begin(), v.end(), t));
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    TEST(statistics_resource_t_test, records_counts_sizes_and_peak) {
+        counting_upstream upstream;
+        statistics_resource_t stats{ upstream, 0 };
+        auto p1 = stats.allocate(1000);
+        stats.deallocate(p1, 1000);
+        void* blocks[4];
+        stats.allocate_bulk(32, 4, blocks);
+        auto p2 = stats.allocate(100, 64);
+        EXPECT_EQ(5, upstream.allocations);
+        auto s = stats.stats();
+        EXPECT_EQ(228U, s.live_bytes);
+        EXPECT_EQ(1000U, s.peak_bytes);
+        EXPECT_EQ(1228U, s.allocated_bytes);
+        EXPECT_EQ(6U, s.allocations);
+        EXPECT_EQ(1U, s.deallocations);
+        EXPECT_EQ(1U, s.histogram[9]);
+        EXPECT_EQ(4U, s.histogram[5]);
+        EXPECT_EQ(1U, s.histogram[6]);
+        auto text = s.to_string();
+        EXPECT_NE(std::string::npos, text.find("live_bytes 228\n"));
+        EXPECT_NE(std::string::npos, text.find("size_2^5 4\n"));
+        EXPECT_EQ(std::string::npos, text.find("size_2^4 "));
+        stats.deallocate(p2, 100, 64);
+        stats.deallocate_bulk(blocks, 4, 32);
+        EXPECT_EQ(0U, stats.stats().live_bytes);
+        EXPECT_EQ(0, upstream.allocations);
+    }
+
+    TEST(statistics_resource_t_test, peak_is_tracked_at_granularity) {
+        statistics_resource_t stats{ default_poly_allocator::instance(), 4096 };
+        auto p1 = stats.allocate(3000);
+        stats.deallocate(p1, 3000);
+        EXPECT_EQ(0U, stats.stats().peak_bytes);
+        auto p2 = stats.allocate(5000);
+        EXPECT_EQ(5000U, stats.stats().peak_bytes);
+        stats.deallocate(p2, 5000);
+        EXPECT_EQ(5000U, stats.stats().peak_bytes);
+    }
+
+    TEST(statistics_resource_t_test, frees_by_other_threads_keep_the_peak_sane) {
+        statistics_resource_t stats;
+        auto p1 = stats.allocate(4000);
+        // the freeing thread starts while the allocating one still runs,
+        // so they have counters of their own
+        std::thread([&] {
+            auto p2 = stats.allocate(4000);
+            std::thread([&] {
+                stats.deallocate(p1, 4000);
+                stats.deallocate(p2, 4000);
+            }).join();
+        }).join();
+        auto p3 = stats.allocate(200);
+        auto s = stats.stats();
+        EXPECT_EQ(200U, s.live_bytes);
+        // the peak of 8000 bytes may be missed by peak_granularity bytes
+        // per thread but must not wrap around
+        EXPECT_GE(s.peak_bytes, s.live_bytes);
+        EXPECT_LE(s.peak_bytes, 8000U);
+        stats.deallocate(p3, 200);
+    }
+
+    TEST(statistics_resource_t_test, destroyed_while_a_bound_thread_exits) {
+        for (int i = 0; i < 200; ++i) {
+            std::unique_ptr<statistics_resource_t> stats{ new statistics_resource_t };
+            std::atomic<bool> used{ false };
+            std::thread t{ [&] {
+                stats->deallocate(stats->allocate(48), 48);
+                used = true;
+                // varies the interleaving with the destruction
+                std::this_thread::sleep_for(std::chrono::microseconds(i % 50));
+            } };
+            while (!used) {
+                std::this_thread::yield();
+            }
+            stats.reset();
+            t.join();
+        }
+    }
+
+    TEST(statistics_resource_t_test, counters_of_all_threads_are_summed) {
+        statistics_resource_t stats;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&stats] {
+                std::list<int, statistics_resource_t::allocator<int>> l{ stats.get_allocator<int>() };
+                for (int i = 0; i < 1000; ++i) {
+                    l.push_back(i);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        auto s = stats.stats();
+        EXPECT_EQ(4000U, s.allocations);
+        EXPECT_EQ(4000U, s.deallocations);
+        EXPECT_EQ(0U, s.live_bytes);
+        EXPECT_GT(s.peak_bytes, 0U);
+        EXPECT_EQ(4000U, std::accumulate(std::begin(s.histogram), std::end(s.histogram), size_t{ 0 }));
+    }
+
+    TEST(concurrent_pool_t_test, blocks_are_reused_without_headers) {
+        counting_upstream upstream;
+        concurrent_pool_t pool{ upstream };
+        auto p1 = static_cast<uint8_t*>(pool.allocate(32));
+        auto p2 = static_cast<uint8_t*>(pool.allocate(20));
+        EXPECT_EQ(p1 + 32, p2);
+        EXPECT_EQ(1, upstream.allocations);
+        pool.deallocate(p1, 32);
+        EXPECT_EQ(p1, pool.allocate(32));
+    }
+
+    TEST(concurrent_pool_t_test, returns_chunks_and_forwards_large_requests) {
+        counting_upstream upstream;
+        {
+            concurrent_pool_t pool{ upstream, 64 };
+            auto p1 = pool.allocate(65);
+            auto p2 = pool.allocate(8, 128);
+            EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p2) % 128);
+            EXPECT_EQ(2, upstream.allocations);
+            pool.deallocate(p1, 65);
+            pool.deallocate(p2, 8, 128);
+            for (int i = 0; i < 10000; ++i) {
+                pool.allocate(48);
+            }
+            EXPECT_LT(0, upstream.allocations);
+        }
+        EXPECT_EQ(0, upstream.allocations);
+    }
+
+    TEST(concurrent_pool_t_test, remote_frees_are_drained_by_the_owning_heap) {
+        concurrent_pool_t pool;
+        std::vector<void*> blocks(10);
+        std::thread producer{ [&] {
+            for (auto& p : blocks) {
+                p = pool.allocate(64);
+            }
+        } };
+        producer.join();
+        for (auto p : blocks) {
+            pool.deallocate(p, 64);
+        }
+        // the heap of the exited thread is adopted
+        std::vector<void*> reused(10);
+        std::thread t{ [&] {
+            for (auto& p : reused) {
+                p = pool.allocate(64);
+            }
+        } };
+        t.join();
+        std::sort(blocks.begin(), blocks.end());
+        std::sort(reused.begin(), reused.end());
+        EXPECT_EQ(blocks, reused);
+    }
+
+    TEST(concurrent_pool_t_test, interfaces_produced_and_consumed_by_different_threads) {
+        concurrent_pool_t pool;
+        using task_t = interface_t<concurrent_pool_t::allocator<uint8_t>, int()>;
+        std::mutex mutex;
+        std::deque<task_t> queue;
+        constexpr int count = 2000;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < count; ++i) {
+                    std::array<int, 16> capture{ { i } };
+                    task_t task{ std::allocator_arg, pool.get_allocator(),
+                        [capture]() { return capture[0]; } };
+                    std::lock_guard<std::mutex> lock{ mutex };
+                    queue.push_back(std::move(task));
+                }
+            });
+        }
+        long long sum = 0;
+        for (int consumed = 0; consumed < 2 * count;) {
+            std::unique_ptr<task_t> task;
+            {
+                std::lock_guard<std::mutex> lock{ mutex };
+                if (queue.empty()) {
+                    continue;
+                }
+                task.reset(new task_t(std::move(queue.front())));
+                queue.pop_front();
+            }
+            sum += (*task)();
+            ++consumed;
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        EXPECT_EQ(2LL * count * (count - 1) / 2, sum);
+    }
+
+    TEST(tlsf_t_test, coalesces_freed_neighbours) {
+        std::vector<uint8_t> region(4096);
+        tlsf_t tlsf{ memory_resource_t{ region.data(), region.size() } };
+        auto initial = tlsf.free_size();
+        EXPECT_LT(region.size() - 4 * tlsf_t::granularity, initial);
+        auto p1 = tlsf.allocate(1000);
+        auto p2 = tlsf.allocate(1000);
+        auto p3 = tlsf.allocate(1000);
+        EXPECT_THROW(tlsf.allocate(1100), std::bad_alloc);
+        tlsf.deallocate(p2, 1000);
+        tlsf.deallocate(p1, 1000);
+        tlsf.deallocate(p3, 1000);
+        EXPECT_EQ(initial, tlsf.free_size());
+        auto p = tlsf.allocate(initial / 2 + 1);
+        EXPECT_TRUE(within(p, region.data(), region.size()));
+    }
+
+    TEST(tlsf_t_test, aligned_allocations) {
+        std::vector<uint8_t> region(16384);
+        tlsf_t tlsf{ memory_resource_t{ region.data(), region.size() } };
+        auto initial = tlsf.free_size();
+        std::vector<std::pair<void*, size_t>> blocks;
+        for (size_t alignment : { 32, 64, 256, 1024 }) {
+            auto p = tlsf.allocate(40, alignment);
+            EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p) % alignment);
+            std::memset(p, 0xcd, 40);
+            blocks.emplace_back(p, alignment);
+        }
+        for (auto& b : blocks) {
+            tlsf.deallocate(b.first, 40, b.second);
+        }
+        EXPECT_EQ(initial, tlsf.free_size());
+    }
+
+    TEST(tlsf_t_test, random_allocations_keep_blocks_intact) {
+        std::vector<uint8_t> region(1 << 16);
+        tlsf_t tlsf{ memory_resource_t{ region.data(), region.size() } };
+        auto initial = tlsf.free_size();
+        struct live_t {
+            uint8_t* p;
+            size_t n;
+            size_t alignment;
+        };
+        std::vector<live_t> live;
+        std::mt19937 random{ 7 };
+        auto release = [&](size_t i) {
+            auto b = live[i];
+            auto pattern = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(b.p) >> 4);
+            EXPECT_EQ(b.n, static_cast<size_t>(std::count(b.p, b.p + b.n, pattern)));
+            tlsf.deallocate(b.p, b.n, b.alignment);
+            live[i] = live.back();
+            live.pop_back();
+        };
+        const size_t alignments[] = { 1, 8, 16, 64 };
+        for (int i = 0; i < 20000; ++i) {
+            if (live.empty() || random() % 3) {
+                live_t b{ nullptr, 1 + random() % 1500, alignments[random() % 4] };
+                try {
+                    b.p = static_cast<uint8_t*>(tlsf.allocate(b.n, b.alignment));
+                } catch (const std::bad_alloc&) {
+                    release(random() % live.size());
+                    continue;
+                }
+                EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(b.p) % b.alignment);
+                ASSERT_TRUE(within(b.p, region.data(), region.size()));
+                std::memset(b.p, static_cast<uint8_t>(reinterpret_cast<uintptr_t>(b.p) >> 4), b.n);
+                live.push_back(b);
+            } else {
+                release(random() % live.size());
+            }
+        }
+        while (!live.empty()) {
+            release(live.size() - 1);
+        }
+        EXPECT_EQ(initial, tlsf.free_size());
+    }
+
+    TEST(tlsf_t_test, byte_allocator_for_interfaces) {
+        std::vector<uint8_t> region(2048);
+        tlsf_t tlsf{ memory_resource_t{ region.data(), region.size() } };
+        using task_t = interface_t<tlsf_t::allocator<uint8_t>, double()>;
+        std::array<double, 64> capture{ { 2.0 } };
+        std::vector<task_t> tasks;
+        EXPECT_THROW(
+            for (int i = 0; i < 10; ++i) {
+                tasks.emplace_back(std::allocator_arg, tlsf.get_allocator(),
+                    [capture]() { return capture[0]; });
+            }, std::bad_alloc);
+        EXPECT_LE(3U, tasks.size());
+        EXPECT_EQ(2.0, tasks.front()());
+    }
+
+    using small_buddy_t = buddy_resource_t<64, 4096>;
+
+    TEST(buddy_resource_t_test, splits_and_merges_buddies) {
+        // 128 bytes of bitmaps and two blocks of the largest order
+        alignas(64) uint8_t region[128 + 2 * 4096];
+        small_buddy_t buddy{ memory_resource_t{ region, sizeof(region) } };
+        auto initial = buddy.free_size();
+        EXPECT_EQ(2 * 4096U, initial);
+        EXPECT_EQ(4096U, buddy.largest_free_block());
+        EXPECT_EQ(128U, small_buddy_t::block_size_for(65));
+        auto p1 = static_cast<uint8_t*>(buddy.allocate(64));
+        auto p2 = static_cast<uint8_t*>(buddy.allocate(50));
+        EXPECT_EQ(p1 + 64, p2);
+        EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(p1) % 64);
+        auto p3 = static_cast<uint8_t*>(buddy.allocate(1000));
+        EXPECT_EQ(0U, (p3 - p1) % 1024);
+        EXPECT_EQ(initial - 64 - 64 - 1024, buddy.free_size());
+        buddy.deallocate(p2, 50);
+        buddy.deallocate(p3, 1000);
+        buddy.deallocate(p1, 64);
+        EXPECT_EQ(initial, buddy.free_size());
+        EXPECT_EQ(p1, buddy.allocate(4096));
+    }
+
+    TEST(buddy_resource_t_test, manages_regions_of_any_size) {
+        // 3 * 4096 + 512 + 64 managed bytes, at most
+        std::vector<uint8_t> region(3 * 4096 + 512 + 64 + 200);
+        small_buddy_t buddy{ memory_resource_t{ region.data(), region.size() } };
+        auto initial = buddy.free_size();
+        EXPECT_EQ(0U, initial % 64);
+        std::vector<void*> blocks;
+        try {
+            for (;;) {
+                blocks.push_back(buddy.allocate(64));
+            }
+        } catch (const std::bad_alloc&) {
+        }
+        EXPECT_EQ(initial / 64, blocks.size());
+        EXPECT_EQ(0U, buddy.free_size());
+        for (auto p : blocks) {
+            EXPECT_TRUE(within(p, region.data(), region.size()));
+            buddy.deallocate(p, 64);
+        }
+        EXPECT_EQ(initial, buddy.free_size());
+        EXPECT_EQ(4096U, buddy.largest_free_block());
+        EXPECT_THROW(buddy.allocate(4097), std::bad_alloc);
+    }
+
+    TEST(buddy_resource_t_test, random_allocations_keep_blocks_intact) {
+        std::vector<uint8_t> region(1 << 16);
+        small_buddy_t buddy{ memory_resource_t{ region.data(), region.size() } };
+        auto initial = buddy.free_size();
+        std::vector<std::pair<uint8_t*, size_t>> live;
+        std::mt19937 random{ 3 };
+        auto release = [&](size_t i) {
+            auto b = live[i];
+            auto pattern = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(b.first) >> 6);
+            EXPECT_EQ(b.second, static_cast<size_t>(std::count(b.first, b.first + b.second, pattern)));
+            buddy.deallocate(b.first, b.second);
+            live[i] = live.back();
+            live.pop_back();
+        };
+        for (int i = 0; i < 20000; ++i) {
+            if (live.empty() || random() % 3) {
+                auto n = 1 + random() % 3000;
+                uint8_t* p;
+                try {
+                    p = static_cast<uint8_t*>(buddy.allocate(n));
+                } catch (const std::bad_alloc&) {
+                    release(random() % live.size());
+                    continue;
+                }
+                ASSERT_TRUE(within(p, region.data(), region.size()));
+                std::memset(p, static_cast<uint8_t>(reinterpret_cast<uintptr_t>(p) >> 6), n);
+                live.emplace_back(p, n);
+            } else {
+                release(random() % live.size());
+            }
+        }
+        while (!live.empty()) {
+            release(live.size() - 1);
+        }
+        EXPECT_EQ(initial, buddy.free_size());
+    }
+
+    TEST(map_memory_test, maps_usable_memory_with_fallbacks) {
+        mapping_options_t options;
+        options.populate = true;
+        options.lock = true;
+        auto m = map_memory(100000, options);
+        ASSERT_NE(nullptr, m.data());
+        EXPECT_GE(m.size(), 100000U);
+        EXPECT_TRUE(m.populated());
+        if (m.huge_pages() || m.huge_pages_advised()) {
+            EXPECT_EQ(0U, m.size() % mapped_memory_t::huge_page_size);
+            EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(m.data()) % mapped_memory_t::huge_page_size);
+        }
+        monotonic_arena_t arena{ m.resource() };
+        auto p = static_cast<uint8_t*>(arena.allocate(m.size(), 1));
+        std::fill(p, p + m.size(), uint8_t{ 0xab });
+        EXPECT_THROW(arena.allocate(1, 1), std::bad_alloc);
+    }
+
+    TEST(map_memory_test, normal_pages_and_moves) {
+        mapping_options_t options;
+        options.huge_pages = false;
+        auto m1 = map_memory(1, options);
+        EXPECT_FALSE(m1.huge_pages());
+        EXPECT_FALSE(m1.huge_pages_advised());
+        EXPECT_FALSE(m1.locked());
+        auto data = m1.data();
+        auto m2 = std::move(m1);
+        EXPECT_EQ(nullptr, m1.data());
+        EXPECT_FALSE(m1.resource());
+        EXPECT_EQ(data, m2.resource().ptr());
+        slab_pool_t pool{ m2.resource(), default_poly_allocator::instance() };
+        EXPECT_TRUE(within(pool.allocate(16), m2.data(), m2.size()));
+    }
+
+}  // namespace MemResourceTest
@@ -90,6 +90,153 @@ TEST(ObjStorageTest, when_heap_allocation_happens_pointer_address_is_aligned) {
     EXPECT_EQ(0,reinterpret_cast<std::uintptr_t>(o1.get()) % alignment);
 }
 
+TEST(ObjStorageTest, heap_allocation_does_not_pad_when_alignment_is_fundamental) {
+    estd::sso_storage o1{};
+    o1.allocate(estd::sso_storage::max_size() + 1);
+    EXPECT_EQ(estd::sso_storage::max_size() + 1, o1.size());
+}
+
+TEST(ObjStorageTest, over_aligned_heap_allocation_does_not_pad_with_std_allocator) {
+    constexpr size_t alignment = 64;
+    using storage_t = estd::sso_storage_t<4, alignment>;
+    storage_t o1{ storage_t::max_size() + 1 };
+    storage_t o2{ o1 };
+    EXPECT_EQ(storage_t::max_size() + 1, o1.size());
+    EXPECT_EQ(0U, reinterpret_cast<std::uintptr_t>(o1.get()) % alignment);
+    EXPECT_EQ(0U, reinterpret_cast<std::uintptr_t>(o2.get()) % alignment);
+}
+
+TEST(ObjStorageTest, heap_allocation_uses_aligned_allocate_extension_of_allocator) {
+    using ::testing::Return;
+    constexpr size_t alignment = 64;
+    using storage_t = estd::sso_storage_t<4, alignment, Mock::AlignedAllocatorMock<uint8_t>>;
+    constexpr size_t alloc_size = storage_t::max_size() + 1;
+    auto ptr = Mock::pointer<uint8_t>(0xc0de0040);
+    storage_t o1{};
+
+    EXPECT_CALL(o1.get_allocator(), allocate(alloc_size, alignment))
+        .WillOnce(Return(ptr));
+    o1.allocate(alloc_size);
+    EXPECT_EQ(ptr, o1.get());
+    EXPECT_EQ(alloc_size, o1.size());
+
+    EXPECT_CALL(o1.get_allocator(), deallocate(ptr, alloc_size, alignment));
+    o1.deallocate();
+}
+
+// hands out blocks in multiples of 64 bytes
+struct AtLeastAllocator {
+    using value_type = uint8_t;
+    static constexpr size_t granularity = 64;
+
+    estd::impl::allocation_result<uint8_t*> allocate_at_least(size_t n)
+    {
+        auto count = (n + granularity - 1) / granularity * granularity;
+        return { allocate(count), count };
+    }
+    uint8_t* allocate(size_t n)
+    {
+        return std::allocator<uint8_t>{}.allocate(n);
+    }
+    void deallocate(uint8_t* p, size_t n) noexcept
+    {
+        std::allocator<uint8_t>{}.deallocate(p, n);
+    }
+    bool operator==(const AtLeastAllocator&) const noexcept { return true; }
+};
+
+TEST(ObjStorageTest, capacity_is_max_size_when_allocated_inline) {
+    estd::sso_storage o1{}, o2{ 1 };
+    EXPECT_EQ(0U, o1.capacity());
+    EXPECT_EQ(estd::sso_storage::max_size(), o2.capacity());
+}
+
+TEST(ObjStorageTest, capacity_reports_the_size_provided_by_allocate_at_least) {
+    using storage_t = estd::sso_storage_t<4, alignof(std::max_align_t), AtLeastAllocator>;
+    storage_t o1{ storage_t::max_size() + 1 };
+    EXPECT_EQ(0U, (o1.size() % AtLeastAllocator::granularity));
+    EXPECT_EQ(o1.size() - storage_t::alignment, o1.capacity());
+    EXPECT_GE(o1.capacity(), storage_t::max_size() + 1);
+}
+
+TEST(ObjStorageTest, reallocate_allocates_unallocated_storage) {
+    estd::sso_storage o1{};
+    EXPECT_EQ(estd::sso_storage::max_size(), o1.reallocate(1));
+    EXPECT_TRUE(inline_allocation_happened(o1));
+}
+
+TEST(ObjStorageTest, reallocate_grows_inline_storage_in_place_up_to_max_size) {
+    estd::sso_storage o1{ 1 };
+    auto p = o1.get();
+    EXPECT_TRUE(o1.try_expand_in_place(estd::sso_storage::max_size()));
+    EXPECT_EQ(estd::sso_storage::max_size(), o1.reallocate(estd::sso_storage::max_size()));
+    EXPECT_EQ(p, o1.get());
+    EXPECT_FALSE(o1.try_expand_in_place(estd::sso_storage::max_size() + 1));
+}
+
+TEST(ObjStorageTest, reallocate_migrates_inline_storage_to_heap_keeping_contents) {
+    constexpr auto max_size = estd::sso_storage::max_size();
+    estd::sso_storage o1{ max_size };
+    fill_storage(o1, 1);
+    auto capacity = o1.reallocate(max_size * 4);
+    EXPECT_GE(capacity, max_size * 4);
+    EXPECT_GE(o1.capacity(), max_size * 4);
+    EXPECT_FALSE(inline_allocation_happened(o1));
+    EXPECT_TRUE(validate_storage(o1.get(), max_size, 1));
+}
+
+TEST(ObjStorageTest, reallocate_moves_heap_storage_keeping_contents) {
+    constexpr auto max_size = estd::sso_storage::max_size();
+    estd::sso_storage o1{ max_size * 2 };
+    fill_storage(o1, 3);
+    o1.reallocate(max_size * 8);
+    EXPECT_GE(o1.capacity(), max_size * 8);
+    EXPECT_TRUE(validate_storage(o1.get(), max_size * 2, 3));
+}
+
+TEST(ObjStorageTest, reallocate_to_smaller_size_keeps_allocation) {
+    constexpr auto max_size = estd::sso_storage::max_size();
+    estd::sso_storage o1{ max_size * 2 };
+    auto p = o1.get();
+    EXPECT_EQ(o1.capacity(), o1.reallocate(1));
+    EXPECT_EQ(p, o1.get());
+}
+
+TEST(ObjStorageTest, reallocate_leaves_storage_unchanged_when_relocation_throws) {
+    constexpr auto max_size = estd::sso_storage::max_size();
+    estd::sso_storage o1{ max_size };
+    auto p = o1.get();
+    EXPECT_THROW(o1.reallocate(max_size * 2, [](void*, void*) {
+        throw std::runtime_error("relocation failed");
+    }), std::runtime_error);
+    EXPECT_EQ(p, o1.get());
+    EXPECT_EQ(max_size, o1.size());
+}
+
+TEST(ObjStorageTest, reallocate_uses_try_expand_of_allocator) {
+    using ::testing::_;
+    using ::testing::Return;
+    using storage_t = estd::sso_storage_t<4, 8, Mock::ExpandingAllocatorMock<uint8_t>>;
+    constexpr auto alloc_size = storage_t::max_size() + 1;
+    constexpr auto raw_size = alloc_size + storage_t::alignment;
+    auto ptr = Mock::pointer<uint8_t>(0xc0de0040);
+    storage_t o1{};
+
+    EXPECT_CALL(o1.get_allocator(), allocate(raw_size)).WillOnce(Return(ptr));
+    o1.allocate(alloc_size);
+
+    EXPECT_CALL(o1.get_allocator(), try_expand(ptr, raw_size, raw_size * 2))
+        .WillOnce(Return(true));
+    EXPECT_EQ(raw_size * 2 - storage_t::alignment,
+        o1.reallocate(raw_size * 2 - storage_t::alignment, [](void*, void*) {
+            FAIL() << "relocation is not expected";
+        }));
+    EXPECT_EQ(ptr, o1.get());
+
+    EXPECT_CALL(o1.get_allocator(), deallocate(ptr, raw_size * 2));
+    o1.deallocate();
+}
+
 TEST(ObjStorageTest, zero_size_allocation_results_in_size_1) {
     estd::sso_storage o1{};
     o1.allocate(0);
@@ -223,17 +370,20 @@ INSTANTIATE_TEST_CASE_P(
 // Param 3 - PropOnCMove 
 // Param 4 - PropOnCSwap 
 // Param 5 - initial alloc size in bytes
+// Param 6 - LayoutPolicy (optional)
 
 
 using AllocationTestInlineTypes = ::testing::Types<
     std::tuple<Size<4>, Size<8>, std::true_type, std::true_type, std::true_type, Size<0>>,
     std::tuple<Size<4>, Size<8>, std::true_type, std::true_type, std::true_type, Size<1>>,
-    std::tuple<Size<4>, Size<8>, std::true_type, std::true_type, std::true_type, Size<4 * sizeof(void*)>>
+    std::tuple<Size<4>, Size<8>, std::true_type, std::true_type, std::true_type, Size<4 * sizeof(void*)>>,
+    std::tuple<Size<4>, Size<8>, std::true_type, std::true_type, std::true_type, Size<1>, estd::UnionLayoutPolicy>
 >;
 
 using AllocationTestAllocatedTypes = ::testing::Types<
     std::tuple<Size<4>, Size<8>, std::true_type, std::true_type, std::true_type, Size<4 * sizeof(void*)+1>>,
-    std::tuple<Size<4>, Size<8>, std::true_type, std::true_type, std::true_type, Size<8 * sizeof(void*)>>
+    std::tuple<Size<4>, Size<8>, std::true_type, std::true_type, std::true_type, Size<8 * sizeof(void*)>>,
+    std::tuple<Size<4>, Size<8>, std::true_type, std::true_type, std::true_type, Size<8 * sizeof(void*)>, estd::UnionLayoutPolicy>
 >;
 
 using AllocationTestTypes = ::testing::Types<
@@ -244,7 +394,11 @@ using AllocationTestTypes = ::testing::Types<
     std::tuple<Size<8>, Size<8>, std::true_type, std::true_type, std::true_type, Size<8 * sizeof(void*)>>,
     std::tuple<Size<8>, Size<8>, std::false_type, std::true_type, std::true_type, Size<8 * sizeof(void*)>>,
     std::tuple<Size<8>, Size<8>, std::true_type, std::false_type, std::true_type, Size<8 * sizeof(void*)>>,
-    std::tuple<Size<8>, Size<8>, std::true_type, std::true_type, std::false_type, Size<8 * sizeof(void*)>>
+    std::tuple<Size<8>, Size<8>, std::true_type, std::true_type, std::false_type, Size<8 * sizeof(void*)>>,
+    std::tuple<Size<4>, Size<8>, std::true_type, std::true_type, std::true_type, Size<8 * sizeof(void*)>, estd::UnionLayoutPolicy>,
+    std::tuple<Size<4>, Size<8>, std::false_type, std::true_type, std::true_type, Size<8 * sizeof(void*)>, estd::UnionLayoutPolicy>,
+    std::tuple<Size<4>, Size<8>, std::true_type, std::false_type, std::true_type, Size<8 * sizeof(void*)>, estd::UnionLayoutPolicy>,
+    std::tuple<Size<4>, Size<8>, std::true_type, std::true_type, std::false_type, Size<8 * sizeof(void*)>, estd::UnionLayoutPolicy>
 >;
 
 
@@ -1,4 +1,5 @@
 #include "test_poly_obj_storage.h"
+#include "functional.h"
 
 #ifdef _MSC_VER
 __declspec(dllexport)
@@ -9,6 +10,7 @@ int PullInTestPolyObjStorageLibrary() { return 0; }
 namespace PolyStorageTest {
 
 std::atomic<int> IF::index { 0 };
+int RelocatableImpl::moves { 0 };
 
 TEST_F(PolyStorageBasicTest, ConstructionAndUse) {
 
@@ -112,5 +114,171 @@ TEST_F(PolyStorageBasicTest, SwapAllocated) {
     EXPECT_EQ(p_s2, t2.get());
 }
 
+TEST(PolyStorageUnionLayoutTest, SwapMixed) {
+    using storage_t = estd::polymorphic_obj_storage_t<IF, estd::impl::DefaultCloningPolicy,
+        4, alignof(std::max_align_t), std::allocator<uint8_t>, estd::UnionLayoutPolicy>;
+    storage_t s1(Impl1{}), s2(Impl2{});
+    auto i_s1 = s1->get_index();
+    auto i_s2 = s2->get_index();
+    auto p_s2 = s2.get();
+    using std::swap;
+    swap(s1, s2);
+    EXPECT_EQ(IF::from_impl1, s2->func());
+    EXPECT_EQ(IF::from_impl2, s1->func());
+    EXPECT_EQ(i_s1, s2->get_index());
+    EXPECT_EQ(i_s2, s1->get_index());
+    EXPECT_EQ(p_s2, s1.get());
+    swap(s1, s2);
+    EXPECT_EQ(IF::from_impl1, s1->func());
+    EXPECT_EQ(IF::from_impl2, s2->func());
+    EXPECT_EQ(i_s1, s1->get_index());
+    EXPECT_EQ(i_s2, s2->get_index());
+    EXPECT_EQ(p_s2, s2.get());
+}
+
+TEST(PolyStorageRelocationTest, RelocatableIsRecordedOnConstruction) {
+    estd::polymorphic_obj_storage_t<IF> s1(RelocatableImpl{}), s2(Impl1{});
+    EXPECT_TRUE(s1.trivially_relocatable());
+    EXPECT_FALSE(s2.trivially_relocatable());
+    estd::polymorphic_obj_storage_t<IF> s3(s1);
+    EXPECT_TRUE(s3.trivially_relocatable());
+    // the flag is kept in the object pointer
+    struct untagged {
+        estd::polymorphic_obj_storage_t<IF>::storage_t storage;
+        IF* obj;
+    };
+    EXPECT_EQ(sizeof(untagged), sizeof(s1));
+}
+
+TEST(PolyStorageRelocationTest, MoveDoesNotCallVirtualMove) {
+    estd::polymorphic_obj_storage_t<IF> s1(RelocatableImpl{}), s2(Impl1{});
+    auto i_s1 = s1->get_index();
+    auto moves = RelocatableImpl::moves;
+    estd::polymorphic_obj_storage_t<IF> t1(std::move(s1));
+    EXPECT_EQ(moves, RelocatableImpl::moves);
+    EXPECT_TRUE(t1.trivially_relocatable());
+    EXPECT_EQ(i_s1, t1->get_index());
+    EXPECT_EQ(IF::from_impl1, t1->func());
+    EXPECT_FALSE(s1);
+    s2 = std::move(t1);
+    EXPECT_EQ(moves, RelocatableImpl::moves);
+    EXPECT_TRUE(s2.trivially_relocatable());
+    EXPECT_EQ(i_s1, s2->get_index());
+    EXPECT_FALSE(t1);
+}
+
+TEST(PolyStorageRelocationTest, SwapInlineRelocatableAndNonRelocatable) {
+    estd::polymorphic_obj_storage_t<IF> s1(RelocatableImpl{}), s2(Impl1{});
+    auto i_s1 = s1->get_index();
+    auto i_s2 = s2->get_index();
+    auto moves = RelocatableImpl::moves;
+    using std::swap;
+    swap(s1, s2);
+    EXPECT_EQ(moves, RelocatableImpl::moves);
+    EXPECT_FALSE(s1.trivially_relocatable());
+    EXPECT_TRUE(s2.trivially_relocatable());
+    EXPECT_EQ(i_s2, s1->get_index());
+    EXPECT_EQ(i_s1, s2->get_index());
+}
+
+TEST(PolyStorageRelocationTest, SwapMixedUnionLayout) {
+    using storage_t = estd::polymorphic_obj_storage_t<IF, estd::impl::DefaultCloningPolicy,
+        4, alignof(std::max_align_t), std::allocator<uint8_t>, estd::UnionLayoutPolicy>;
+    storage_t s1(RelocatableImpl{}), s2(Impl2{});
+    auto i_s1 = s1->get_index();
+    auto i_s2 = s2->get_index();
+    auto moves = RelocatableImpl::moves;
+    using std::swap;
+    swap(s1, s2);
+    EXPECT_EQ(moves, RelocatableImpl::moves);
+    EXPECT_EQ(IF::from_impl2, s1->func());
+    EXPECT_EQ(IF::from_impl1, s2->func());
+    EXPECT_EQ(i_s2, s1->get_index());
+    EXPECT_EQ(i_s1, s2->get_index());
+}
+
+TEST(PolyStorageRelocationTest, VectorGrowthKeepsObjects) {
+    std::vector<estd::polymorphic_obj_storage_t<IF>> v;
+    std::vector<int> indices;
+    auto moves = RelocatableImpl::moves;
+    for (int i = 0; i < 33; ++i) {
+        v.emplace_back(RelocatableImpl{});
+        indices.push_back(v.back()->get_index());
+    }
+    EXPECT_EQ(moves, RelocatableImpl::moves);
+    for (size_t i = 0; i < v.size(); ++i) {
+        EXPECT_EQ(indices[i], v[i]->get_index());
+    }
+}
+
+TEST(PolyStorageRelocationTest, InterfaceBindingInheritsRelocatability) {
+    using if_t = estd::impl::IInterface<int()>;
+    auto l = [i = 1]() { return i; };
+    EXPECT_TRUE((estd::is_trivially_relocatable<
+        estd::impl::BindImpl<if_t, decltype(l), int()>>::value));
+    EXPECT_FALSE((estd::is_trivially_relocatable<
+        estd::impl::BindImpl<if_t, std::vector<int>, int()>>::value));
+}
+
+TEST(PolyStorageEmplaceTest, InPlaceConstructionDoesNotMove) {
+    auto moves = RelocatableImpl::moves;
+    estd::polymorphic_obj_storage_t<IF> s1(estd::in_place_type<Impl2>);
+    estd::polymorphic_obj_storage_t<IF> s2(std::allocator_arg,
+        std::allocator<uint8_t>{}, estd::in_place_type<RelocatableImpl>);
+    EXPECT_EQ(IF::from_impl2, s1->func());
+    EXPECT_EQ(IF::from_impl1, s2->func());
+    EXPECT_TRUE(s2.trivially_relocatable());
+    EXPECT_EQ(moves, RelocatableImpl::moves);
+}
+
+TEST(PolyStorageEmplaceTest, EmplaceReusesAllocationOfSameSize) {
+    estd::polymorphic_obj_storage_t<IF> s(Impl2{});
+    auto p = s.get();
+    auto& o = s.emplace<Impl2>();
+    EXPECT_EQ(p, s.get());
+    EXPECT_EQ(static_cast<IF*>(&o), s.get());
+    s.emplace<Impl1>();
+    EXPECT_EQ(IF::from_impl1, s->func());
+    EXPECT_FALSE(s.trivially_relocatable());
+    s.emplace<RelocatableImpl>();
+    EXPECT_TRUE(s.trivially_relocatable());
+    estd::polymorphic_obj_storage_t<IF> empty;
+    empty.emplace<Impl2>();
+    EXPECT_EQ(IF::from_impl2, empty->func());
+}
+
+TEST(PolyStorageEmplaceTest, EmplaceReallocatesIfPaddedHeapBlockIsTooSmall) {
+    // heap sizes of the padded allocation include the 64 bytes of alignment
+    using storage_t = estd::polymorphic_obj_storage_t<IF, estd::impl::DefaultCloningPolicy,
+        4, 64, UnequalAllocator>;
+    storage_t s(estd::in_place_type<SizedImpl<48>>);
+    auto& o1 = s.emplace<SizedImpl<112>>();
+    std::fill(std::begin(o1.payload), std::end(o1.payload), uint8_t{ 1 });
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(s.get()) % 64);
+    auto p = s.get();
+    s.emplace<SizedImpl<64>>();
+    EXPECT_EQ(p, s.get());
+    s.emplace<Impl1>();
+    EXPECT_EQ(IF::from_impl1, s->func());
+    auto offset = reinterpret_cast<uintptr_t>(s.get()) - reinterpret_cast<uintptr_t>(&s);
+    EXPECT_LT(offset, sizeof(s));
+    auto& o2 = s.emplace<SizedImpl<112>>();
+    std::fill(std::begin(o2.payload), std::end(o2.payload), uint8_t{ 2 });
+    EXPECT_EQ(IF::from_impl1, s->func());
+}
+
+TEST(PolyStorageRelocationTest, MoveAssignWithUnequalAllocatorsRelocatesHeapObject) {
+    using storage_t = estd::polymorphic_obj_storage_t<IF, estd::impl::DefaultCloningPolicy,
+        4, alignof(std::max_align_t), UnequalAllocator>;
+    storage_t s1(LargeRelocatableImpl{}), s2;
+    auto i_s1 = s1->get_index();
+    auto p_s1 = s1.get();
+    auto moves = RelocatableImpl::moves;
+    s2 = std::move(s1);
+    EXPECT_EQ(moves, RelocatableImpl::moves);
+    EXPECT_NE(p_s1, s2.get());
+    EXPECT_EQ(i_s1, s2->get_index());
+    EXPECT_FALSE(s1);
+}
 
 }
@@ -0,0 +1,281 @@
+#include <exception>
+#include <string>
+#include <memory>
+#include <vector>
+
+#include "vector.h"
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#ifdef _MSC_VER
+__declspec(dllexport)
+#endif  // _MSC_VER
+int PullInTestSmallVectorLibrary() { return 0; }
+
+namespace SmallVectorTest {
+
+// Stateful allocator, instances compare equal if their ids are equal
+template<
+    typename T,
+    class PropOnCCopy = std::true_type,
+    class PropOnCMove = std::true_type,
+    class PropOnCSwap = std::true_type
+>
+struct TaggedAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = PropOnCCopy;
+    using propagate_on_container_move_assignment = PropOnCMove;
+    using propagate_on_container_swap = PropOnCSwap;
+    using is_always_equal = std::false_type;
+
+    template<typename TT>
+    using TT_allocator = TaggedAllocator<TT, PropOnCCopy, PropOnCMove, PropOnCSwap>;
+
+    explicit TaggedAllocator(int i = 0) noexcept : id{ i } {}
+
+    template<typename TT>
+    TaggedAllocator(const TT_allocator<TT>& a) noexcept : id{ a.id } {}
+
+    T* allocate(size_t n)
+    {
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept
+    {
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template<typename TT>
+    bool operator==(const TT_allocator<TT>& rhs) const noexcept
+    {
+        return id == rhs.id;
+    }
+
+    template<typename TT>
+    bool operator!=(const TT_allocator<TT>& rhs) const noexcept
+    {
+        return id != rhs.id;
+    }
+
+    int id;
+};
+
+using ivec = estd::small_vector<int, 4>;
+using svec = estd::small_vector<std::string, 2>;
+
+template<typename V>
+V make_sequence(size_t n)
+{
+    V v;
+    for (size_t i = 0; i < n; ++i) {
+        v.push_back(static_cast<typename V::value_type>(i));
+    }
+    return v;
+}
+
+svec make_strings(size_t n)
+{
+    svec v;
+    for (size_t i = 0; i < n; ++i) {
+        v.push_back(std::string(32, static_cast<char>('a' + i)));
+    }
+    return v;
+}
+
+TEST(SmallVectorTest, default_constructed_vector_is_empty_and_does_not_allocate) {
+    ivec v;
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(0U, v.size());
+    EXPECT_GE(v.capacity(), 4U);
+    EXPECT_TRUE(v.is_inline());
+}
+
+TEST(SmallVectorTest, elements_up_to_inline_capacity_are_stored_inline) {
+    ivec v;
+    for (int i = 0; i < static_cast<int>(ivec::inline_capacity); ++i) {
+        v.push_back(i);
+    }
+    auto addr = reinterpret_cast<uintptr_t>(v.data());
+    auto obj_addr = reinterpret_cast<uintptr_t>(&v);
+    EXPECT_TRUE(v.is_inline());
+    EXPECT_LT(addr - obj_addr, sizeof(v));
+}
+
+TEST(SmallVectorTest, push_back_spills_to_heap_and_keeps_elements) {
+    auto v = make_sequence<ivec>(64);
+    EXPECT_FALSE(v.is_inline());
+    ASSERT_EQ(64U, v.size());
+    for (int i = 0; i < 64; ++i) {
+        EXPECT_EQ(i, v[i]);
+    }
+}
+
+TEST(SmallVectorTest, non_trivially_relocatable_elements_survive_growth) {
+    auto v = make_strings(16);
+    ASSERT_EQ(16U, v.size());
+    for (size_t i = 0; i < v.size(); ++i) {
+        EXPECT_EQ(std::string(32, static_cast<char>('a' + i)), v[i]);
+    }
+}
+
+TEST(SmallVectorTest, push_back_of_own_element_during_growth) {
+    auto v = make_strings(2);
+    auto capacity = v.capacity();
+    v.resize(capacity);
+    v.push_back(v[0]);
+    EXPECT_EQ(v[0], v.back());
+}
+
+TEST(SmallVectorTest, initializer_list_and_range_construction) {
+    ivec v1{ 1, 2, 3, 4, 5, 6 };
+    std::vector<int> s{ 1, 2, 3, 4, 5, 6 };
+    ivec v2(s.begin(), s.end());
+    EXPECT_TRUE(std::equal(v1.begin(), v1.end(), s.begin(), s.end()));
+    EXPECT_EQ(v1, v2);
+}
+
+TEST(SmallVectorTest, at_throws_when_out_of_range) {
+    ivec v{ 1 };
+    EXPECT_EQ(1, v.at(0));
+    EXPECT_THROW(v.at(1), std::out_of_range);
+}
+
+TEST(SmallVectorTest, insert_and_erase) {
+    ivec v{ 1, 2, 4, 5 };
+    v.insert(v.begin() + 2, 3);
+    EXPECT_EQ((ivec{ 1, 2, 3, 4, 5 }), v);
+    v.erase(v.begin());
+    EXPECT_EQ((ivec{ 2, 3, 4, 5 }), v);
+    v.erase(v.begin() + 1, v.end() - 1);
+    EXPECT_EQ((ivec{ 2, 5 }), v);
+    v.pop_back();
+    EXPECT_EQ((ivec{ 2 }), v);
+}
+
+TEST(SmallVectorTest, resize_value_initializes_new_elements) {
+    ivec v{ 1 };
+    v.resize(10);
+    EXPECT_EQ(10U, v.size());
+    EXPECT_EQ(1, v[0]);
+    EXPECT_EQ(0, v[9]);
+    v.resize(2, 7);
+    EXPECT_EQ((ivec{ 1, 0 }), v);
+}
+
+TEST(SmallVectorTest, copy_construction_copies_elements) {
+    for (size_t n : { 0, 1, 2, 8 }) {
+        auto v1 = make_strings(n);
+        svec v2(v1);
+        EXPECT_EQ(v1, v2);
+    }
+}
+
+TEST(SmallVectorTest, move_construction_takes_over_heap_storage) {
+    auto v1 = make_strings(8);
+    auto data = v1.data();
+    svec v2(std::move(v1));
+    EXPECT_EQ(data, v2.data());
+    EXPECT_EQ(make_strings(8), v2);
+    EXPECT_TRUE(v1.empty());
+}
+
+TEST(SmallVectorTest, move_construction_relocates_inline_elements) {
+    auto v1 = make_strings(2);
+    svec v2(std::move(v1));
+    EXPECT_EQ(make_strings(2), v2);
+    EXPECT_TRUE(v1.empty());
+}
+
+TEST(SmallVectorTest, copy_and_move_assignment) {
+    for (size_t n : { 0, 1, 2, 8 }) {
+        for (size_t m : { 0, 1, 2, 8 }) {
+            auto v1 = make_strings(n);
+            auto v2 = make_strings(m);
+            v2 = v1;
+            EXPECT_EQ(v1, v2);
+            auto v3 = make_strings(m);
+            v3 = std::move(v1);
+            EXPECT_EQ(v2, v3);
+            EXPECT_TRUE(v1.empty());
+        }
+    }
+}
+
+TEST(SmallVectorTest, swap_exchanges_elements_for_all_allocation_states) {
+    for (size_t n : { 0, 1, 2, 8 }) {
+        for (size_t m : { 0, 1, 2, 8 }) {
+            auto v1 = make_strings(n);
+            auto v2 = make_strings(m);
+            using std::swap;
+            swap(v1, v2);
+            EXPECT_EQ(make_strings(m), v1);
+            EXPECT_EQ(make_strings(n), v2);
+        }
+    }
+}
+
+TEST(SmallVectorTest, works_with_poly_alloc_wrapper) {
+    estd::poly_alloc_impl<std::allocator<uint8_t>> a;
+    using pvec = estd::small_vector<int, 2, estd::poly_alloc_wrapper<int>>;
+    pvec v{ estd::poly_alloc_wrapper<int>(a) };
+    for (int i = 0; i < 16; ++i) {
+        v.push_back(i);
+    }
+    EXPECT_EQ(&a, &v.get_allocator().allocator());
+    pvec v2(v);
+    EXPECT_EQ(v, v2);
+}
+
+TEST(SmallVectorTest, copy_assignment_propagates_allocator_if_pocca) {
+    using alloc_t = TaggedAllocator<int>;
+    using vec_t = estd::small_vector<int, 2, alloc_t>;
+    vec_t v1(alloc_t{ 1 }), v2(alloc_t{ 2 });
+    v1.assign({ 1, 2, 3, 4 });
+    v2.assign({ 5, 6, 7, 8, 9 });
+    v2 = v1;
+    EXPECT_EQ(1, v2.get_allocator().id);
+    EXPECT_EQ(v1, v2);
+}
+
+TEST(SmallVectorTest, copy_assignment_keeps_allocator_if_not_pocca) {
+    using alloc_t = TaggedAllocator<int, std::false_type>;
+    using vec_t = estd::small_vector<int, 2, alloc_t>;
+    vec_t v1(alloc_t{ 1 }), v2(alloc_t{ 2 });
+    v1.assign({ 1, 2, 3, 4 });
+    v2 = v1;
+    EXPECT_EQ(2, v2.get_allocator().id);
+    EXPECT_EQ(v1, v2);
+}
+
+TEST(SmallVectorTest, move_assignment_moves_elements_if_allocators_differ_and_not_pocma) {
+    using alloc_t = TaggedAllocator<int, std::true_type, std::false_type>;
+    using vec_t = estd::small_vector<int, 2, alloc_t>;
+    vec_t v1(alloc_t{ 1 }), v2(alloc_t{ 2 });
+    v1.assign({ 1, 2, 3, 4 });
+    auto data = v1.data();
+    v2 = std::move(v1);
+    EXPECT_EQ(2, v2.get_allocator().id);
+    EXPECT_NE(data, v2.data());
+    EXPECT_EQ((vec_t{ { 1, 2, 3, 4 }, alloc_t{ 2 } }), v2);
+}
+
+TEST(SmallVectorTest, swap_propagates_allocators_if_pocs) {
+    using alloc_t = TaggedAllocator<int>;
+    using vec_t = estd::small_vector<int, 2, alloc_t>;
+    vec_t v1({ 1 }, alloc_t{ 1 }), v2({ 1, 2, 3, 4 }, alloc_t{ 2 });
+    swap(v1, v2);
+    EXPECT_EQ(2, v1.get_allocator().id);
+    EXPECT_EQ(1, v2.get_allocator().id);
+    EXPECT_EQ((vec_t{ 1, 2, 3, 4 }), v1);
+    EXPECT_EQ((vec_t{ 1 }), v2);
+}
+
+TEST(SmallVectorTest, swap_throws_if_allocators_differ_and_not_pocs) {
+    using alloc_t = TaggedAllocator<int, std::true_type, std::true_type, std::false_type>;
+    using vec_t = estd::small_vector<int, 2, alloc_t>;
+    vec_t v1({ 1 }, alloc_t{ 1 }), v2({ 1, 2, 3, 4 }, alloc_t{ 2 });
+    EXPECT_THROW(swap(v1, v2), std::exception);
+}
+
+}  // namespace SmallVectorTest